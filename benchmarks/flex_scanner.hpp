@@ -0,0 +1,12 @@
+#ifndef FLEX_SCANNER_HPP
+#define FLEX_SCANNER_HPP
+
+#include "symbols.hpp"
+
+#include <string_view>
+
+// scans the source with the scanner generated by flex from src/input.flex,
+// an ERROR token is counted and stops the scanning like in LexicalAnalyzer::tokenize
+size_t flexCountTokens(std::string_view source);
+
+#endif // FLEX_SCANNER_HPP
@@ -0,0 +1,182 @@
+#include "lexical_analyzer/dfa_constructor.hpp"
+#include "lexical_analyzer/glushkov_constructor.hpp"
+#include "lexical_analyzer/lazy_dfa_constructor.hpp"
+#include "lexical_analyzer/scheme_rules.hpp"
+#include "lexical_analyzer/token_stream.hpp"
+#ifdef WITH_FLEX_SCANNER
+#include "flex_scanner.hpp"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <sstream>
+
+static constexpr int64_t minCorpusSize = 1 << 10;
+static constexpr int64_t maxCorpusSize = 100 << 20;
+
+// a synthetic Scheme program of the given size, the same size always gives the same program
+static const std::string &getCorpus(size_t size)
+{
+    static std::map<size_t, std::string> corpora;
+    auto [it, wasInserted] = corpora.try_emplace(size);
+    std::string &corpus = it->second;
+    if (!wasInserted) {
+        return corpus;
+    }
+
+    corpus.reserve(size + 256);
+    for (size_t i = 0; corpus.size() < size; ++i) {
+        const std::string n = std::to_string(i);
+        corpus += "; procedure number " + n + " computes (something) with [brackets]\n";
+        corpus += "(define (procedure" + n + " first second)\n";
+        corpus += "    (begin\n";
+        corpus += "        (display \"the value of procedure " + n + " is \")\n";
+        corpus += "        (if (<= first " + n + ") (+ first second " + n + ") #f)))\n";
+        corpus += "(define variable" + n + " (procedure" + n + " " + n + " 'sym" + n + "))\n";
+        corpus += "(display #\\a) (display #t)\n\n";
+    }
+    // the corpus ends at a newline, so no token is cut
+    corpus.resize(corpus.rfind('\n', size) + 1);
+    return corpus;
+}
+
+static void setCounters(benchmark::State &state, size_t bytesCount, size_t tokensCount)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytesCount));
+    state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokensCount),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template <typename Constructor>
+static void tokenizeBenchmark(benchmark::State &state)
+{
+    const auto &corpus = getCorpus(state.range(0));
+    auto constructor = std::make_shared<Constructor>();
+    addSchemeRules(*constructor);
+    LexicalAnalyzer lexicalAnalyzer(constructor);
+    // the automaton is built lazily, so the first run isn't measured
+    lexicalAnalyzer.tokenize("(define x 1)");
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        const auto tokens = lexicalAnalyzer.tokenize(corpus);
+        tokensCount = tokens.size();
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+}
+
+static void tokenizeGeneratedTablesBenchmark(benchmark::State &state)
+{
+    const auto &corpus = getCorpus(state.range(0));
+    LexicalAnalyzer lexicalAnalyzer(makeSchemeDfaConstructor());
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        const auto tokens = lexicalAnalyzer.tokenize(corpus);
+        tokensCount = tokens.size();
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+}
+
+static void tokenizeParallelBenchmark(benchmark::State &state)
+{
+    const auto &corpus = getCorpus(state.range(0));
+    LexicalAnalyzer lexicalAnalyzer(makeSchemeDfaConstructor());
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        const auto tokens = lexicalAnalyzer.tokenizeParallel(corpus);
+        tokensCount = tokens.size();
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+}
+
+static void tokenStreamBenchmark(benchmark::State &state)
+{
+    const auto &corpus = getCorpus(state.range(0));
+    LexicalAnalyzer lexicalAnalyzer(makeSchemeDfaConstructor());
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::istringstream input(corpus);
+        state.ResumeTiming();
+        auto tokenStream = lexicalAnalyzer.stream(input);
+        tokensCount = 0;
+        while (tokenStream.next()) {
+            ++tokensCount;
+        }
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+}
+
+// every token is followed by a scan to the end of the input looking for 'b', which is quadratic
+// unless the failed scans are memoized
+static void pathologicalBenchmark(benchmark::State &state)
+{
+    const std::string corpus(state.range(0), 'a');
+    auto constructor = std::make_shared<DfaConstructor>();
+    constructor->addRule("a", TerminalSymbol::ID);
+    constructor->addRule("a*b", TerminalSymbol::INT);
+    LexicalAnalyzer lexicalAnalyzer(constructor);
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        const auto tokens = lexicalAnalyzer.tokenize(corpus);
+        tokensCount = tokens.size();
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+    state.SetComplexityN(state.range(0));
+}
+
+#ifdef WITH_FLEX_SCANNER
+static void flexBenchmark(benchmark::State &state)
+{
+    const auto &corpus = getCorpus(state.range(0));
+
+    size_t tokensCount = 0;
+    for (auto _ : state) {
+        tokensCount = flexCountTokens(corpus);
+        benchmark::DoNotOptimize(tokensCount);
+    }
+    setCounters(state, corpus.size(), tokensCount);
+}
+#endif
+
+// the corpus sizes are 1 KB, 10 KB, ..., 100 MB
+#define LEXER_BENCHMARK(func)                                                                      \
+    BENCHMARK(func)                                                                                \
+        ->RangeMultiplier(10)                                                                      \
+        ->Range(minCorpusSize, maxCorpusSize)                                                      \
+        ->Unit(benchmark::kMillisecond)
+
+// the NFA simulation takes minutes for the biggest corpora, so they are skipped
+BENCHMARK(tokenizeBenchmark<ThompsonConstructor>)
+    ->RangeMultiplier(10)
+    ->Range(minCorpusSize, 1 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->Name("Thompson");
+LEXER_BENCHMARK(tokenizeBenchmark<GlushkovConstructor>)->Name("Glushkov");
+LEXER_BENCHMARK(tokenizeBenchmark<DfaConstructor>)->Name("Dfa");
+LEXER_BENCHMARK(tokenizeBenchmark<LazyDfaConstructor>)->Name("LazyDfa");
+LEXER_BENCHMARK(tokenizeGeneratedTablesBenchmark)->Name("DfaGeneratedTables");
+LEXER_BENCHMARK(tokenStreamBenchmark)->Name("DfaTokenStream");
+// the CPU time of the main thread doesn't count the lexing threads
+LEXER_BENCHMARK(tokenizeParallelBenchmark)->UseRealTime()->Name("DfaParallel");
+// every byte is a token here, so the biggest corpora are skipped as well
+BENCHMARK(pathologicalBenchmark)
+    ->RangeMultiplier(10)
+    ->Range(minCorpusSize, 10 << 20)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oN)
+    ->Name("PathologicalDfa");
+#ifdef WITH_FLEX_SCANNER
+LEXER_BENCHMARK(flexBenchmark)->Name("Flex");
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,115 @@
+#include "byte_ranges.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BYTE_RANGES_X86
+#include <immintrin.h>
+#endif
+
+static size_t spanScalar(std::string_view str, size_t i, const ByteRanges &ranges)
+{
+    for (; i < str.size(); ++i) {
+        const auto byte = static_cast<uint8_t>(str[i]);
+        bool isInRanges = false;
+        for (size_t range = 0; range < ranges.count && !isInRanges; ++range) {
+            isInRanges = ranges.lows[range] <= byte && byte <= ranges.highs[range];
+        }
+        if (!isInRanges) {
+            break;
+        }
+    }
+    return i;
+}
+
+#ifdef BYTE_RANGES_X86
+
+// byte - low <= high - low in unsigned arithmetic checks both bounds with a single comparison,
+// min(x, y) == x is used as the unsigned x <= y that SSE2 lacks
+
+static size_t spanSse2(std::string_view str, const ByteRanges &ranges)
+{
+    constexpr size_t width = 16;
+    __m128i lows[ByteRanges::maxRanges], widths[ByteRanges::maxRanges];
+    for (size_t range = 0; range < ranges.count; ++range) {
+        lows[range] = _mm_set1_epi8(static_cast<char>(ranges.lows[range]));
+        widths[range] =
+            _mm_set1_epi8(static_cast<char>(ranges.highs[range] - ranges.lows[range]));
+    }
+
+    size_t i = 0;
+    for (; i + width <= str.size(); i += width) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str.data() + i));
+        __m128i isInRanges = _mm_setzero_si128();
+        for (size_t range = 0; range < ranges.count; ++range) {
+            const __m128i offsets = _mm_sub_epi8(bytes, lows[range]);
+            isInRanges = _mm_or_si128(
+                isInRanges, _mm_cmpeq_epi8(_mm_min_epu8(offsets, widths[range]), offsets));
+        }
+        const auto outOfRanges = ~static_cast<uint32_t>(_mm_movemask_epi8(isInRanges)) & 0xFFFF;
+        if (outOfRanges != 0) {
+            return i + __builtin_ctz(outOfRanges);
+        }
+    }
+    return spanScalar(str, i, ranges);
+}
+
+__attribute__((target("avx2"))) static size_t spanAvx2(std::string_view str,
+                                                       const ByteRanges &ranges)
+{
+    constexpr size_t width = 32;
+    __m256i lows[ByteRanges::maxRanges], widths[ByteRanges::maxRanges];
+    for (size_t range = 0; range < ranges.count; ++range) {
+        lows[range] = _mm256_set1_epi8(static_cast<char>(ranges.lows[range]));
+        widths[range] =
+            _mm256_set1_epi8(static_cast<char>(ranges.highs[range] - ranges.lows[range]));
+    }
+
+    size_t i = 0;
+    for (; i + width <= str.size(); i += width) {
+        const __m256i bytes =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str.data() + i));
+        __m256i isInRanges = _mm256_setzero_si256();
+        for (size_t range = 0; range < ranges.count; ++range) {
+            const __m256i offsets = _mm256_sub_epi8(bytes, lows[range]);
+            isInRanges = _mm256_or_si256(
+                isInRanges,
+                _mm256_cmpeq_epi8(_mm256_min_epu8(offsets, widths[range]), offsets));
+        }
+        const auto outOfRanges = ~static_cast<uint32_t>(_mm256_movemask_epi8(isInRanges));
+        if (outOfRanges != 0) {
+            return i + __builtin_ctz(outOfRanges);
+        }
+    }
+    return spanScalar(str, i, ranges);
+}
+
+#endif // BYTE_RANGES_X86
+
+SimdLevel getSupportedSimdLevel()
+{
+#ifdef BYTE_RANGES_X86
+    static const SimdLevel supportedLevel = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::SCALAR;
+    }();
+    return supportedLevel;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+size_t spanByteRanges(std::string_view str, const ByteRanges &ranges, SimdLevel level)
+{
+    switch (level) {
+#ifdef BYTE_RANGES_X86
+    case SimdLevel::AVX2:
+        return spanAvx2(str, ranges);
+    case SimdLevel::SSE2:
+        return spanSse2(str, ranges);
+#endif
+    default:
+        return spanScalar(str, 0, ranges);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef BYTE_RANGES_HPP
+#define BYTE_RANGES_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// the vector instructions used to check many bytes at once, ordered by the width
+enum class SimdLevel : uint8_t
+{
+    SCALAR,
+    SSE2, // 16 bytes
+    AVX2  // 32 bytes
+};
+
+// the best level supported by the running CPU
+SimdLevel getSupportedSimdLevel();
+
+// a set of bytes given by a few inclusive ranges, so it can be checked by vector comparisons
+struct ByteRanges
+{
+    static constexpr size_t maxRanges = 8;
+
+    // returns false when the bytes don't fit into maxRanges ranges
+    template <typename IsInSet>
+    bool assign(const IsInSet &isInSet);
+
+    size_t count = 0;
+    std::array<uint8_t, maxRanges> lows, highs;
+};
+
+// returns the length of the longest prefix of str with all the bytes in the ranges,
+// the level must be supported by the CPU
+size_t spanByteRanges(std::string_view str, const ByteRanges &ranges, SimdLevel level);
+
+template <typename IsInSet>
+bool ByteRanges::assign(const IsInSet &isInSet)
+{
+    count = 0;
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        if (!isInSet(static_cast<uint8_t>(byte))) {
+            continue;
+        }
+        if (count != 0 && highs[count - 1] + 1u == byte) {
+            highs[count - 1] = byte;
+            continue;
+        }
+        if (count == maxRanges) {
+            count = 0;
+            return false;
+        }
+        lows[count] = highs[count] = byte;
+        ++count;
+    }
+    return true;
+}
+
+#endif // BYTE_RANGES_HPP
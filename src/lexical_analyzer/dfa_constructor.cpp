@@ -0,0 +1,403 @@
+#include "dfa_constructor.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <stack>
+
+DfaConstructor::DfaConstructor() {}
+
+DfaConstructor::DfaConstructor(const Tables &tables)
+    : isDfaBuilt(true), isLoadedFromTables(true), startState(tables.startState),
+      classesCount(tables.classesCount),
+      transitions(tables.transitions.begin(), tables.transitions.end()),
+      acceptingTokens(tables.acceptingTokens.begin(), tables.acceptingTokens.end())
+{
+    ASSERT(transitions.size() == acceptingTokens.size() * classesCount);
+    ASSERT(startState < acceptingTokens.size());
+    std::copy(tables.byteClasses.begin(), tables.byteClasses.end(), byteClasses.begin());
+    buildSelfLoops();
+}
+
+DfaConstructor::~DfaConstructor() {}
+
+std::unique_ptr<LexicalAnalyzerConstructor> DfaConstructor::clone()
+{
+    buildDfa();
+    return std::make_unique<DfaConstructor>(*this);
+}
+
+void DfaConstructor::addRule(std::string rule, TerminalSymbol tokenToReturn)
+{
+    ASSERT_MSG(!isLoadedFromTables, "Rules can't be added to the DFA loaded from tables");
+    ThompsonConstructor::addRule(std::move(rule), tokenToReturn);
+    isDfaBuilt = false;
+    currentInput = {};
+}
+
+size_t DfaConstructor::getStatesCount()
+{
+    buildDfa();
+    return acceptingTokens.size();
+}
+
+size_t DfaConstructor::getClassesCount()
+{
+    buildDfa();
+    return classesCount;
+}
+
+void DfaConstructor::setSimdLevel(SimdLevel level)
+{
+    ASSERT_MSG(level <= getSupportedSimdLevel(), "The SIMD level isn't supported by the CPU");
+    simdLevel = level;
+}
+
+void DfaConstructor::writeTables(std::ostream &stream, std::string_view name)
+{
+    buildDfa();
+
+    auto writeArray = [&](std::string_view type, std::string_view arrayName, size_t size,
+                          size_t valuesPerLine, const auto &writeValue) {
+        stream << "constexpr " << type << " " << arrayName << "[" << size << "] = {";
+        for (size_t i = 0; i < size; ++i) {
+            stream << (i % valuesPerLine == 0 ? "\n    " : " ");
+            writeValue(i);
+            stream << ",";
+        }
+        stream << "\n};\n\n";
+    };
+
+    stream << "namespace {\n\n";
+    writeArray("uint8_t", "byteClasses", alphabetSize, 16,
+               [&](size_t i) { stream << static_cast<unsigned>(byteClasses[i]); });
+    // a row of the table per line
+    writeArray("DfaConstructor::DfaState", "transitions", transitions.size(), classesCount,
+               [&](size_t i) { stream << transitions[i]; });
+    writeArray("std::optional<TerminalSymbol>", "acceptingTokens", acceptingTokens.size(), 1,
+               [&](size_t i) {
+                   if (const auto &token = acceptingTokens[i]) {
+                       stream << "TerminalSymbol::" << magic_enum::enum_name(*token);
+                   } else {
+                       stream << "std::nullopt";
+                   }
+               });
+    stream << "} // namespace\n\n";
+    stream << "extern const DfaConstructor::Tables " << name << ";\n";
+    stream << "const DfaConstructor::Tables " << name << " = {" << startState << ", "
+           << classesCount << ", byteClasses, transitions, acceptingTokens};\n";
+}
+
+void DfaConstructor::buildDfa()
+{
+    if (isDfaBuilt) {
+        return;
+    }
+    determinize();
+    // folding the bytes first makes the minimization run over classes instead of bytes, the
+    // minimized DFA may have more bytes with identical behaviour, so they are folded once again
+    buildByteClasses();
+    minimize();
+    buildByteClasses();
+    buildSelfLoops();
+    isDfaBuilt = true;
+}
+
+void DfaConstructor::determinize()
+{
+    // the winning rule is resolved here, so every DFA state carries the token to return
+    auto getAcceptingToken = [&](const VerticesSet &vertices) -> std::optional<TerminalSymbol> {
+        const auto winner = automaton.getWinningVertice(vertices);
+        return winner ? std::make_optional(winner->tokenToReturn) : std::nullopt;
+    };
+
+    startState = 1;
+    const VerticesSet startSet = automaton.epsClosure({*startVertice});
+    std::map<VerticesSet, DfaState> dfaStates = {{{}, deadState}, {startSet, startState}};
+    classesCount = alphabetSize;
+    std::iota(byteClasses.begin(), byteClasses.end(), 0);
+    transitions.assign(2 * alphabetSize, deadState);
+    acceptingTokens = {std::nullopt, getAcceptingToken(startSet)};
+
+    std::stack<std::pair<VerticesSet, DfaState>> toProcess;
+    toProcess.push({startSet, startState});
+    while (!toProcess.empty()) {
+        const auto [vertices, state] = toProcess.top();
+        toProcess.pop();
+
+        std::array<VerticesSet, alphabetSize> moves;
+        VerticesSet anyMoves;
+        for (const auto vertice : vertices) {
+            for (auto transIndex = automaton.vertices[vertice].firstTransition;
+                 transIndex != Transition::noTransition;
+                 transIndex = automaton.transitions[transIndex].nextTransition) {
+                const auto &trans = automaton.transitions[transIndex];
+                if (trans.symbol.kind == TransitionSymbol::Kind::CHAR) {
+                    moves[static_cast<unsigned char>(trans.symbol.symbol)].push_back(
+                        trans.dstVertice);
+                } else if (trans.symbol.kind == TransitionSymbol::Kind::ANY) {
+                    anyMoves.push_back(trans.dstVertice);
+                } else if (trans.symbol.kind == TransitionSymbol::Kind::SET) {
+                    const auto &chars = automaton.charSets[trans.symbol.charSet];
+                    for (size_t byte = 0; byte < alphabetSize; ++byte) {
+                        if (chars[byte]) {
+                            moves[byte].push_back(trans.dstVertice);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t byte = 0; byte < alphabetSize; ++byte) {
+            auto &move = moves[byte];
+            move.insert(move.end(), anyMoves.begin(), anyMoves.end());
+            if (move.empty()) {
+                continue;
+            }
+            auto nextVertices = automaton.epsClosure(move);
+            const auto [it, wasInserted] =
+                dfaStates.try_emplace(nextVertices, static_cast<DfaState>(dfaStates.size()));
+            if (wasInserted) {
+                transitions.resize(transitions.size() + alphabetSize, deadState);
+                acceptingTokens.push_back(getAcceptingToken(nextVertices));
+                toProcess.push({std::move(nextVertices), it->second});
+            }
+            transitions[state * alphabetSize + byte] = it->second;
+        }
+    }
+    ASSERT(acceptingTokens.size() * alphabetSize == transitions.size());
+}
+
+void DfaConstructor::buildByteClasses()
+{
+    const size_t statesCount = acceptingTokens.size();
+    // classes with identical columns are merged, the first class of a column gives the new id
+    std::map<std::vector<DfaState>, uint8_t> columnsClasses;
+    std::vector<uint8_t> newClasses(classesCount);
+    for (size_t oldClass = 0; oldClass < classesCount; ++oldClass) {
+        std::vector<DfaState> column(statesCount);
+        for (size_t state = 0; state < statesCount; ++state) {
+            column[state] = transitions[state * classesCount + oldClass];
+        }
+        newClasses[oldClass] =
+            columnsClasses.try_emplace(std::move(column), columnsClasses.size()).first->second;
+    }
+
+    const size_t newClassesCount = columnsClasses.size();
+    std::vector<DfaState> newTransitions(statesCount * newClassesCount);
+    for (size_t state = 0; state < statesCount; ++state) {
+        for (size_t oldClass = 0; oldClass < classesCount; ++oldClass) {
+            newTransitions[state * newClassesCount + newClasses[oldClass]] =
+                transitions[state * classesCount + oldClass];
+        }
+    }
+    for (auto &byteClass : byteClasses) {
+        byteClass = newClasses[byteClass];
+    }
+    classesCount = newClassesCount;
+    transitions = std::move(newTransitions);
+}
+
+void DfaConstructor::buildSelfLoops()
+{
+    selfLoops.assign(acceptingTokens.size(), {});
+    // the dead state is never left, but matching stops on it anyway
+    for (DfaState state = deadState + 1; state < acceptingTokens.size(); ++state) {
+        selfLoops[state].assign([&](uint8_t byte) {
+            return transitions[state * classesCount + byteClasses[byte]] == state;
+        });
+    }
+}
+
+void DfaConstructor::minimize()
+{
+    const size_t statesCount = acceptingTokens.size();
+
+    // the initial partition separates the states by the token they accept
+    std::vector<std::vector<DfaState>> blocks;
+    std::vector<size_t> stateBlock(statesCount);
+    {
+        std::map<std::optional<TerminalSymbol>, size_t> tokenBlocks;
+        for (DfaState state = 0; state < statesCount; ++state) {
+            const auto [it, wasInserted] =
+                tokenBlocks.try_emplace(acceptingTokens[state], blocks.size());
+            if (wasInserted) {
+                blocks.emplace_back();
+            }
+            blocks[it->second].push_back(state);
+            stateBlock[state] = it->second;
+        }
+    }
+
+    // inverse[state * classesCount + class] are the states that go to the state by the class
+    std::vector<std::vector<DfaState>> inverse(statesCount * classesCount);
+    for (DfaState state = 0; state < statesCount; ++state) {
+        for (size_t byteClass = 0; byteClass < classesCount; ++byteClass) {
+            inverse[transitions[state * classesCount + byteClass] * classesCount + byteClass]
+                .push_back(state);
+        }
+    }
+
+    std::vector<size_t> toSplitBy(blocks.size());
+    std::iota(toSplitBy.begin(), toSplitBy.end(), 0);
+    std::vector<bool> isWaiting(blocks.size(), true);
+    std::vector<bool> isMarked(statesCount, false);
+    std::vector<size_t> markedCount(blocks.size(), 0);
+
+    while (!toSplitBy.empty()) {
+        const size_t splitter = toSplitBy.back();
+        toSplitBy.pop_back();
+        isWaiting[splitter] = false;
+        // the splitter itself can be split below, so its states are copied
+        const auto splitterStates = blocks[splitter];
+
+        for (size_t byteClass = 0; byteClass < classesCount; ++byteClass) {
+            std::vector<size_t> touchedBlocks;
+            std::vector<DfaState> markedStates;
+            for (const auto dstState : splitterStates) {
+                for (const auto srcState : inverse[dstState * classesCount + byteClass]) {
+                    if (isMarked[srcState]) {
+                        continue;
+                    }
+                    isMarked[srcState] = true;
+                    markedStates.push_back(srcState);
+                    if (markedCount[stateBlock[srcState]]++ == 0) {
+                        touchedBlocks.push_back(stateBlock[srcState]);
+                    }
+                }
+            }
+
+            for (const auto block : touchedBlocks) {
+                if (markedCount[block] != blocks[block].size()) {
+                    const size_t newBlock = blocks.size();
+                    std::vector<DfaState> marked, unmarked;
+                    for (const auto state : blocks[block]) {
+                        (isMarked[state] ? marked : unmarked).push_back(state);
+                    }
+                    for (const auto state : marked) {
+                        stateBlock[state] = newBlock;
+                    }
+                    blocks[block] = std::move(unmarked);
+                    blocks.push_back(std::move(marked));
+                    markedCount.push_back(0);
+                    if (isWaiting[block]) {
+                        isWaiting.push_back(true);
+                        toSplitBy.push_back(newBlock);
+                    } else {
+                        const bool isNewSmaller = blocks[newBlock].size() < blocks[block].size();
+                        const size_t smaller = isNewSmaller ? newBlock : block;
+                        isWaiting.push_back(isNewSmaller);
+                        isWaiting[smaller] = true;
+                        toSplitBy.push_back(smaller);
+                    }
+                }
+                markedCount[block] = 0;
+            }
+            for (const auto state : markedStates) {
+                isMarked[state] = false;
+            }
+        }
+    }
+
+    // the dead state keeps the id 0, so matching still stops on it
+    std::vector<DfaState> blockState(blocks.size(), deadState);
+    DfaState newStatesCount = 1;
+    for (size_t block = 0; block < blocks.size(); ++block) {
+        if (block != stateBlock[deadState]) {
+            blockState[block] = newStatesCount++;
+        }
+    }
+
+    std::vector<DfaState> newTransitions(newStatesCount * classesCount, deadState);
+    std::vector<std::optional<TerminalSymbol>> newAcceptingTokens(newStatesCount);
+    for (DfaState state = 0; state < statesCount; ++state) {
+        const DfaState newState = blockState[stateBlock[state]];
+        newAcceptingTokens[newState] = acceptingTokens[state];
+        for (size_t byteClass = 0; byteClass < classesCount; ++byteClass) {
+            newTransitions[newState * classesCount + byteClass] =
+                blockState[stateBlock[transitions[state * classesCount + byteClass]]];
+        }
+    }
+    startState = blockState[stateBlock[startState]];
+    transitions = std::move(newTransitions);
+    acceptingTokens = std::move(newAcceptingTokens);
+}
+
+void DfaConstructor::beginInput(std::string_view input, bool isComplete)
+{
+    buildDfa();
+    currentInput = input;
+    isCurrentInputComplete = isComplete;
+    failureMemo.reset(acceptingTokens.size());
+}
+
+LexicalMatch DfaConstructor::matchLongest(std::string_view str)
+{
+    buildDfa();
+
+    // the memo is used only for the suffixes of the current input
+    const auto inputBegin = reinterpret_cast<uintptr_t>(currentInput.data());
+    const auto strBegin = reinterpret_cast<uintptr_t>(str.data());
+    const bool isMemoUsed = !currentInput.empty() && strBegin >= inputBegin &&
+                            strBegin + str.size() == inputBegin + currentInput.size();
+    const size_t position = isMemoUsed ? strBegin - inputBegin : 0;
+    size_t memoEnd = 0;
+    if (isMemoUsed) {
+        failureMemo.dropBefore(position);
+        memoEnd = failureMemo.getEnd() - std::min(failureMemo.getEnd(), position);
+    }
+
+    DfaState state = startState;
+    LexicalMatch match;
+    bool isFailed = false;
+    visitedStates.clear();
+    for (size_t i = 0; i < str.size() && state != deadState;) {
+        if (i < memoEnd) {
+            // the memoized failures are checked byte by byte, they are rare and short
+            if (failureMemo.isFailed(state, position + i)) {
+                isFailed = true;
+                break;
+            }
+            visitedStates.push_back({state, i, i + 1});
+        } else {
+            size_t runBegin = i;
+            if (const auto &selfLoop = selfLoops[state]; selfLoop.count != 0) {
+                // the state doesn't change while the bytes are in its self loop
+                const size_t skipped = spanByteRanges(str.substr(i), selfLoop, simdLevel);
+                i += skipped;
+                if (const auto &acceptingToken = acceptingTokens[state];
+                    acceptingToken && skipped) {
+                    match.length = i;
+                    match.tokenToReturn = *acceptingToken;
+                    visitedStates.clear();
+                    runBegin = i;
+                }
+            }
+            if (isMemoUsed) {
+                visitedStates.push_back({state, runBegin, i + 1});
+            }
+            if (i == str.size()) {
+                break;
+            }
+        }
+        state = transitions[state * classesCount + byteClasses[static_cast<uint8_t>(str[i])]];
+        ++i;
+        if (const auto &acceptingToken = acceptingTokens[state]) {
+            match.length = i;
+            match.tokenToReturn = *acceptingToken;
+            visitedStates.clear();
+        }
+    }
+
+    // no state visited after the last accepting one can reach an accepting state, running out of
+    // the input counts as well when there is no more input
+    if (isMemoUsed && (isFailed || state == deadState || isCurrentInputComplete)) {
+        for (const auto &visited : visitedStates) {
+            failureMemo.markFailed(visited.state, position + visited.begin,
+                                   position + std::min(visited.end, str.size()));
+        }
+    }
+    match.isInputExhausted = state != deadState && !isFailed;
+    return match;
+}
@@ -0,0 +1,98 @@
+#ifndef DFA_CONSTRUCTOR_HPP
+#define DFA_CONSTRUCTOR_HPP
+
+#include "byte_ranges.hpp"
+#include "failure_memo.hpp"
+#include "thompson_constructor.hpp"
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <span>
+
+/*
+ * Builds the rules using Thompson construction and then converts all of them into a single DFA
+ * using subset construction. The DFA is minimized with Hopcroft's algorithm and bytes with
+ * identical behaviour are folded into classes, so the DFA is stored as a small flat table of
+ * (state x byte class) transitions and matching a token is a single pass over its characters.
+ * The DFA is (re)built lazily on the first use after the rules were changed.
+ * The tables can also be written out as C++ source and loaded back, which skips the construction.
+ * The states looping on themselves by a few byte ranges (blanks, comments, strings, identifiers)
+ * skip their runs with vector instructions instead of going through the table byte by byte.
+ * The failed scans are memoized per input, so tokenizing an input is linear even when every token
+ * is followed by a long scan that doesn't match anything.
+ */
+class DfaConstructor : public ThompsonConstructor
+{
+public:
+    using DfaState = uint32_t;
+    static constexpr size_t alphabetSize = 256;
+
+    // views into tables that were built before, usually generated by writeTables
+    struct Tables
+    {
+        DfaState startState;
+        size_t classesCount;
+        std::span<const uint8_t, alphabetSize> byteClasses;
+        std::span<const DfaState> transitions;
+        std::span<const std::optional<TerminalSymbol>> acceptingTokens;
+    };
+
+    DfaConstructor();
+    // the DFA is taken from the tables, the rules can't be added to it
+    explicit DfaConstructor(const Tables &tables);
+    ~DfaConstructor() override;
+
+    void addRule(std::string rule, TerminalSymbol tokenToReturn) override;
+    // the DFA is built before copying, so it is built only once
+    std::unique_ptr<LexicalAnalyzerConstructor> clone() override;
+
+    // the dead state is counted as well
+    size_t getStatesCount();
+    size_t getClassesCount();
+
+    // writes a C++ definition of "const DfaConstructor::Tables <name>"
+    void writeTables(std::ostream &stream, std::string_view name);
+
+    // the best level supported by the CPU is used by default
+    void setSimdLevel(SimdLevel level);
+
+protected:
+    LexicalMatch matchLongest(std::string_view str) override;
+    void beginInput(std::string_view input, bool isComplete) override;
+
+private:
+    static constexpr DfaState deadState = 0;
+
+    void buildDfa();
+    void determinize();
+    void minimize();
+    void buildByteClasses();
+    void buildSelfLoops();
+
+    bool isDfaBuilt = false;
+    bool isLoadedFromTables = false;
+    DfaState startState = deadState;
+    size_t classesCount = 0;
+    std::array<uint8_t, alphabetSize> byteClasses;
+    // transitions[state * classesCount + byteClasses[byte]]
+    std::vector<DfaState> transitions;
+    std::vector<std::optional<TerminalSymbol>> acceptingTokens;
+    // the bytes that keep each state in itself, empty when they don't fit into a few ranges
+    std::vector<ByteRanges> selfLoops;
+    SimdLevel simdLevel = getSupportedSimdLevel();
+
+    // a state visited at the positions [begin, end) of the matched string
+    struct VisitedStates
+    {
+        DfaState state;
+        size_t begin, end;
+    };
+    std::string_view currentInput;
+    bool isCurrentInputComplete = false;
+    FailureMemo failureMemo;
+    // the states visited since the last accepting one, kept here to reuse the memory
+    std::vector<VisitedStates> visitedStates;
+};
+
+#endif // DFA_CONSTRUCTOR_HPP
@@ -0,0 +1,46 @@
+#include "failure_memo.hpp"
+#include "log.hpp"
+
+void FailureMemo::reset(size_t statesCount)
+{
+    wordsPerPosition = (statesCount + 63) / 64;
+    base = 0;
+    failures.clear();
+}
+
+void FailureMemo::dropBefore(size_t position)
+{
+    if (position >= getEnd()) {
+        base = position;
+        failures.clear();
+    } else if (position > base && (position - base) * 2 * wordsPerPosition > failures.size()) {
+        // the window is moved only when the dropped part is the bigger one, so it's amortized
+        failures.erase(failures.begin(),
+                       failures.begin() + (position - base) * wordsPerPosition);
+        base = position;
+    }
+}
+
+size_t FailureMemo::getEnd() const
+{
+    return base + failures.size() / wordsPerPosition;
+}
+
+bool FailureMemo::isFailed(uint32_t state, size_t position) const
+{
+    if (position < base || position >= getEnd()) {
+        return false;
+    }
+    return failures[(position - base) * wordsPerPosition + state / 64] >> (state % 64) & 1;
+}
+
+void FailureMemo::markFailed(uint32_t state, size_t begin, size_t end)
+{
+    ASSERT(begin >= base && begin <= end);
+    if (end > getEnd()) {
+        failures.resize((end - base) * wordsPerPosition, 0);
+    }
+    for (size_t position = begin; position < end; ++position) {
+        failures[(position - base) * wordsPerPosition + state / 64] |= uint64_t(1) << (state % 64);
+    }
+}
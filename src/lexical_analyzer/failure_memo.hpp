@@ -0,0 +1,36 @@
+#ifndef FAILURE_MEMO_HPP
+#define FAILURE_MEMO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Remembers the (DFA state, input position) pairs from which the scan can't reach any accepting
+ * state further in the input (Reps, "Maximal-Munch" Tokenization in Linear Time). A scan reaching
+ * such a pair stops at once, so every pair is scanned to the failure only once and tokenizing the
+ * whole input is linear. Only the window of positions between the current token and the furthest
+ * failure is kept.
+ */
+class FailureMemo
+{
+public:
+    void reset(size_t statesCount);
+    // the positions before the given one aren't needed anymore
+    void dropBefore(size_t position);
+
+    // there are no failures at the returned position and after it
+    size_t getEnd() const;
+    bool isFailed(uint32_t state, size_t position) const;
+    // marks the state as failed at the positions [begin, end)
+    void markFailed(uint32_t state, size_t begin, size_t end);
+
+private:
+    size_t wordsPerPosition = 1;
+    // the position of the first bits in failures
+    size_t base = 0;
+    // failures[(position - base) * wordsPerPosition + state / 64] has the bit of the state
+    std::vector<uint64_t> failures;
+};
+
+#endif // FAILURE_MEMO_HPP
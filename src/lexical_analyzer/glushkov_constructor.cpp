@@ -0,0 +1,318 @@
+#include "glushkov_constructor.hpp"
+#include "log.hpp"
+#include "rule_symbol.hpp"
+
+#include <algorithm>
+#include <bit>
+
+using PositionsSet = std::set<size_t>;
+
+struct GlushkovSubregex
+{
+    PositionsSet first, last;
+    bool isNullable;
+    SubregexType subregexType; // is stored to know whether the finishing symbol matches the type
+};
+
+using MaybeGlushkovSubregex = std::optional<GlushkovSubregex>;
+
+static void addFollow(GlushkovPositions &positions, const PositionsSet &from, const PositionsSet &to)
+{
+    for (const auto position : from) {
+        positions.follow[position].insert(to.begin(), to.end());
+    }
+}
+
+static MaybeGlushkovSubregex processSubregex(std::string_view &ruleTail,
+                                             GlushkovPositions &positions);
+
+static void processPossibleQuantifier(std::string_view &ruleTail, GlushkovPositions &positions,
+                                      GlushkovSubregex &subregex)
+{
+    const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
+    if (const MetaRuleSymbol *metaRuleSymbol =
+            std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol)) {
+        switch (*metaRuleSymbol) {
+            case MetaRuleSymbol::ASTERIX: {
+                ruleTail = ruleTail.substr(1);
+                addFollow(positions, subregex.last, subregex.first);
+                subregex.isNullable = true;
+                break;
+            }
+            case MetaRuleSymbol::PLUS: {
+                ruleTail = ruleTail.substr(1);
+                addFollow(positions, subregex.last, subregex.first);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+static MaybeGlushkovSubregex processSimpleSubregex(std::string_view &ruleTail,
+                                                   GlushkovPositions &positions)
+{
+    const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
+    ruleTail = ruleTail.substr(currRuleSymbol.width);
+    const size_t position = positions.symbols.size();
+    positions.symbols.push_back([&]() -> TransitionSymbol {
+        if (const char *charSymbol = std::get_if<char>(&currRuleSymbol.symbol)) {
+            return {TransitionSymbol::Kind::CHAR, *charSymbol};
+        } else if (const MetaRuleSymbol *metaSymbol =
+                       std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol);
+                   *metaSymbol == MetaRuleSymbol::DOT) {
+            return {TransitionSymbol::Kind::ANY};
+        }
+        SHOULD_NOT_HAPPEN;
+        return {};
+    }());
+    positions.follow.emplace_back();
+    positions.tokens.emplace_back();
+    GlushkovSubregex currSubregex{{position}, {position}, false, SubregexType::SIMPLE};
+    processPossibleQuantifier(ruleTail, positions, currSubregex);
+    return currSubregex;
+}
+
+static MaybeGlushkovSubregex processCharClassSubregex(std::string_view &ruleTail,
+                                                      GlushkovPositions &positions,
+                                                      const CharClass &charClass)
+{
+    ruleTail = ruleTail.substr(charClass.width);
+    const size_t position = positions.symbols.size();
+    positions.symbols.push_back(addCharSet(positions.charSets, charClass.chars));
+    positions.follow.emplace_back();
+    positions.tokens.emplace_back();
+    GlushkovSubregex currSubregex{{position}, {position}, false, SubregexType::UNION};
+    processPossibleQuantifier(ruleTail, positions, currSubregex);
+    return currSubregex;
+}
+
+static MaybeGlushkovSubregex processGroupSubregex(std::string_view &ruleTail,
+                                                  GlushkovPositions &positions)
+{
+    ruleTail = ruleTail.substr(1);
+    // an empty group matches an empty string
+    GlushkovSubregex currSubregex{{}, {}, true, SubregexType::GROUP};
+    for (;;) {
+        const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
+        if (!isRuleSymbolValid(currRuleSymbol)) {
+            return std::nullopt;
+        } else if (doesSubregexLastSymbolMatch(currRuleSymbol, SubregexType::GROUP)) {
+            ruleTail = ruleTail.substr(1);
+            break;
+        }
+
+        auto childSubregex = processSubregex(ruleTail, positions);
+        if (!childSubregex) {
+            return std::nullopt;
+        }
+        addFollow(positions, currSubregex.last, childSubregex->first);
+        if (currSubregex.isNullable) {
+            currSubregex.first.insert(childSubregex->first.begin(), childSubregex->first.end());
+        }
+        if (childSubregex->isNullable) {
+            childSubregex->last.insert(currSubregex.last.begin(), currSubregex.last.end());
+        }
+        currSubregex.last = std::move(childSubregex->last);
+        currSubregex.isNullable = currSubregex.isNullable && childSubregex->isNullable;
+    }
+
+    processPossibleQuantifier(ruleTail, positions, currSubregex);
+    return currSubregex;
+}
+
+static MaybeGlushkovSubregex processUnionSubregex(std::string_view &ruleTail,
+                                                  GlushkovPositions &positions)
+{
+    // a union of single characters is a single position
+    if (const auto charClass = getCharClass(ruleTail)) {
+        return processCharClassSubregex(ruleTail, positions, *charClass);
+    }
+    ruleTail = ruleTail.substr(1);
+    if (!ruleTail.empty() && ruleTail[0] == '^') {
+        // only the unions of single characters can be negated
+        return std::nullopt;
+    }
+    // an empty union doesn't match anything
+    GlushkovSubregex currSubregex{{}, {}, false, SubregexType::UNION};
+    for (;;) {
+        const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
+        if (!isRuleSymbolValid(currRuleSymbol)) {
+            return std::nullopt;
+        } else if (doesSubregexLastSymbolMatch(currRuleSymbol, SubregexType::UNION)) {
+            ruleTail = ruleTail.substr(1);
+            break;
+        }
+
+        const auto charRange = getCharRange(ruleTail);
+        auto childSubregex = charRange ? processCharClassSubregex(ruleTail, positions, *charRange)
+                                       : processSubregex(ruleTail, positions);
+        if (!childSubregex) {
+            return std::nullopt;
+        }
+        currSubregex.first.merge(childSubregex->first);
+        currSubregex.last.merge(childSubregex->last);
+        currSubregex.isNullable = currSubregex.isNullable || childSubregex->isNullable;
+    }
+
+    processPossibleQuantifier(ruleTail, positions, currSubregex);
+    return currSubregex;
+}
+
+static MaybeGlushkovSubregex processSubregex(std::string_view &ruleTail,
+                                             GlushkovPositions &positions)
+{
+    const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
+    if (std::holds_alternative<char>(currRuleSymbol.symbol)) {
+        return processSimpleSubregex(ruleTail, positions);
+    } else if (const MetaRuleSymbol *metaRuleSymbol =
+                   std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol)) {
+        switch (*metaRuleSymbol) {
+            case MetaRuleSymbol::PARENTHESIS_OPEN: {
+                return processGroupSubregex(ruleTail, positions);
+            }
+            case MetaRuleSymbol::BRACKET_OPEN: {
+                return processUnionSubregex(ruleTail, positions);
+            }
+            case MetaRuleSymbol::DOT: {
+                return processSimpleSubregex(ruleTail, positions);
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+GlushkovConstructor::GlushkovConstructor() {}
+GlushkovConstructor::~GlushkovConstructor() {}
+
+std::unique_ptr<LexicalAnalyzerConstructor> GlushkovConstructor::clone()
+{
+    if (!areTablesBuilt) {
+        buildTables();
+        areTablesBuilt = true;
+    }
+    return std::make_unique<GlushkovConstructor>(*this);
+}
+
+void GlushkovConstructor::addRule(std::string rule, TerminalSymbol tokenToReturn)
+{
+    rule = '(' + rule + ')';
+    std::string_view ruleView = rule;
+    MaybeGlushkovSubregex maybeRegex = processSubregex(ruleView, positions);
+    assert(maybeRegex);
+    // the initial state is shared, so an empty match is never reported, as by other constructors
+    positions.follow[0].merge(maybeRegex->first);
+    for (const auto position : maybeRegex->last) {
+        positions.tokens[position] = tokenToReturn;
+    }
+    areTablesBuilt = false;
+}
+
+void GlushkovConstructor::addRules(std::vector<std::string> rules, TerminalSymbol tokenToReturn)
+{
+    for (auto &rule : rules) {
+        addRule(rule, tokenToReturn);
+    }
+}
+
+void GlushkovConstructor::buildTables()
+{
+    const size_t positionsCount = positions.symbols.size();
+    wordsCount = (positionsCount + wordBits - 1) / wordBits;
+    chunksCount = (positionsCount + chunkBits - 1) / chunkBits;
+    auto setBit = [](Word *positionsSet, size_t position) {
+        positionsSet[position / wordBits] |= Word(1) << (position % wordBits);
+    };
+
+    lastPositions.assign(wordsCount, 0);
+    for (size_t position = 1; position < positionsCount; ++position) {
+        if (positions.tokens[position]) {
+            setBit(lastPositions.data(), position);
+        }
+    }
+
+    charMasks.assign(alphabetSize * wordsCount, 0);
+    for (size_t position = 1; position < positionsCount; ++position) {
+        const auto &symbol = positions.symbols[position];
+        for (size_t byte = 0; byte < alphabetSize; ++byte) {
+            if (symbol.matches(static_cast<char>(byte), positions.charSets)) {
+                setBit(&charMasks[byte * wordsCount], position);
+            }
+        }
+    }
+
+    // every entry is built from the entry without its lowest bit, so each entry costs one OR
+    followTable.assign(chunksCount * chunkValues * wordsCount, 0);
+    for (size_t chunk = 0; chunk < chunksCount; ++chunk) {
+        for (size_t value = 1; value < chunkValues; ++value) {
+            Word *entry = &followTable[(chunk * chunkValues + value) * wordsCount];
+            const Word *prevEntry =
+                &followTable[(chunk * chunkValues + (value & (value - 1))) * wordsCount];
+            std::copy(prevEntry, prevEntry + wordsCount, entry);
+            const size_t position = chunk * chunkBits + std::countr_zero(value);
+            if (position < positionsCount) {
+                for (const auto followPosition : positions.follow[position]) {
+                    setBit(entry, followPosition);
+                }
+            }
+        }
+    }
+
+    currPositions.assign(wordsCount, 0);
+    nextPositions.assign(wordsCount, 0);
+}
+
+LexicalMatch GlushkovConstructor::matchLongest(std::string_view str)
+{
+    if (!areTablesBuilt) {
+        buildTables();
+        areTablesBuilt = true;
+    }
+
+    LexicalMatch match;
+    match.isInputExhausted = true;
+    std::fill(currPositions.begin(), currPositions.end(), 0);
+    currPositions[0] = 1;
+
+    for (size_t i = 0; i < str.size(); ++i) {
+        std::fill(nextPositions.begin(), nextPositions.end(), 0);
+        for (size_t chunk = 0; chunk < chunksCount; ++chunk) {
+            const size_t value =
+                (currPositions[chunk * chunkBits / wordBits] >> (chunk * chunkBits % wordBits)) &
+                (chunkValues - 1);
+            if (value == 0) {
+                continue;
+            }
+            const Word *entry = &followTable[(chunk * chunkValues + value) * wordsCount];
+            for (size_t word = 0; word < wordsCount; ++word) {
+                nextPositions[word] |= entry[word];
+            }
+        }
+
+        const Word *charMask = &charMasks[static_cast<unsigned char>(str[i]) * wordsCount];
+        bool isAlive = false;
+        std::optional<size_t> winnerPosition;
+        for (size_t word = 0; word < wordsCount; ++word) {
+            nextPositions[word] &= charMask[word];
+            isAlive = isAlive || nextPositions[word];
+            const Word accepted = nextPositions[word] & lastPositions[word];
+            if (!winnerPosition && accepted) {
+                winnerPosition = word * wordBits + std::countr_zero(accepted);
+            }
+        }
+        if (!isAlive) {
+            match.isInputExhausted = false;
+            break;
+        }
+        if (winnerPosition) {
+            match.length = i + 1;
+            match.tokenToReturn = *positions.tokens[*winnerPosition];
+        }
+        std::swap(currPositions, nextPositions);
+    }
+    return match;
+}
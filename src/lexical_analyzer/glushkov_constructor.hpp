@@ -0,0 +1,64 @@
+#ifndef GLUSHKOV_CONSTRUCTOR_HPP
+#define GLUSHKOV_CONSTRUCTOR_HPP
+
+#include "lexical_analyzer.hpp"
+
+#include <cstdint>
+#include <set>
+
+// positions of all the rules, position 0 is the initial state shared by the rules
+struct GlushkovPositions
+{
+    std::vector<TransitionSymbol> symbols = {{TransitionSymbol::Kind::EPS}};
+    std::vector<std::set<size_t>> follow = {{}};
+    // set only for the positions after which a rule is matched
+    std::vector<std::optional<TerminalSymbol>> tokens = {std::nullopt};
+    std::vector<CharSet> charSets;
+};
+
+/*
+ * Builds a position (Glushkov) automaton for all the rules. Such an automaton doesn't have epsilon
+ * transitions, a state is a set of positions (characters of the rules) which is stored as a bitset,
+ * so the automaton is simulated bit-parallel: a single step is a couple of table lookups and ORs
+ * per machine word of the set.
+ * Positions are numbered in the order the rules were added, so the lowest accepting position
+ * belongs to the rule which wins a tie.
+ */
+class GlushkovConstructor : public LexicalAnalyzerConstructor
+{
+public:
+    GlushkovConstructor();
+    ~GlushkovConstructor() override;
+
+    void addRule(std::string rule, TerminalSymbol tokenToReturn) override;
+    void addRules(std::vector<std::string> rules, TerminalSymbol tokenToReturn) override;
+    // the tables are built before copying, so they are built only once
+    std::unique_ptr<LexicalAnalyzerConstructor> clone() override;
+
+protected:
+    LexicalMatch matchLongest(std::string_view str) override;
+
+private:
+    using Word = uint64_t;
+    static constexpr size_t wordBits = 64;
+    static constexpr size_t chunkBits = 8;
+    static constexpr size_t chunkValues = size_t(1) << chunkBits;
+    static constexpr size_t alphabetSize = 256;
+
+    void buildTables();
+
+    GlushkovPositions positions;
+
+    bool areTablesBuilt = false;
+    size_t wordsCount = 0;
+    size_t chunksCount = 0;
+    // positions after which a rule is matched, wordsCount words
+    std::vector<Word> lastPositions;
+    // positions which can be entered by the byte, (byte x wordsCount)
+    std::vector<Word> charMasks;
+    // union of follow sets of all positions in a chunk of a set, (chunk x chunk value x wordsCount)
+    std::vector<Word> followTable;
+    std::vector<Word> currPositions, nextPositions;
+};
+
+#endif // GLUSHKOV_CONSTRUCTOR_HPP
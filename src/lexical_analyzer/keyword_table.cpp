@@ -0,0 +1,130 @@
+#include "keyword_table.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <bit>
+
+KeywordTable::KeywordTable(const std::vector<std::pair<std::string, TerminalSymbol>> &keywords)
+{
+    if (keywords.empty()) {
+        return;
+    }
+
+    // a few keywords per bucket and a table at most half full make the seeds quick to find
+    constexpr size_t keywordsPerBucket = 4;
+    bucketSeeds.assign((keywords.size() + keywordsPerBucket - 1) / keywordsPerBucket, 0);
+    slots.assign(std::bit_ceil(keywords.size() * 2), {});
+
+    std::vector<std::vector<size_t>> buckets(bucketSeeds.size());
+    for (size_t i = 0; i < keywords.size(); ++i) {
+        ASSERT_MSG(!keywords[i].first.empty(), "A keyword can't be empty");
+        buckets[getBucket(keywords[i].first)].push_back(i);
+    }
+    // the biggest buckets are placed first, while most of the slots are still free
+    std::vector<size_t> bucketsOrder(buckets.size());
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        bucketsOrder[bucket] = bucket;
+    }
+    std::stable_sort(bucketsOrder.begin(), bucketsOrder.end(), [&](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<size_t> bucketSlots;
+    for (const auto bucket : bucketsOrder) {
+        for (uint32_t seed = 0;; ++seed) {
+            bucketSlots.clear();
+            for (const auto keywordIndex : buckets[bucket]) {
+                const auto &keyword = keywords[keywordIndex].first;
+                const size_t slot = getSlot(keyword, seed);
+                if (!slots[slot].keyword.empty() ||
+                    std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end()) {
+                    break;
+                }
+                bucketSlots.push_back(slot);
+            }
+            if (bucketSlots.size() == buckets[bucket].size()) {
+                bucketSeeds[bucket] = seed;
+                break;
+            }
+            // the same keyword always gets the same slot, so no seed would ever separate them
+            ASSERT_MSG(seed < (1u << 20), "The keywords can't be hashed, some was added twice");
+        }
+        for (size_t i = 0; i < bucketSlots.size(); ++i) {
+            slots[bucketSlots[i]] = {keywords[buckets[bucket][i]].first,
+                                     keywords[buckets[bucket][i]].second};
+        }
+    }
+}
+
+KeywordTable::KeywordTable(const Table &table)
+    : bucketSeeds(table.bucketSeeds.begin(), table.bucketSeeds.end())
+{
+    ASSERT(table.slots.empty() || std::has_single_bit(table.slots.size()));
+    ASSERT(table.slots.empty() == table.bucketSeeds.empty());
+    slots.reserve(table.slots.size());
+    for (const auto &entry : table.slots) {
+        slots.push_back({std::string(entry.keyword), entry.tokenToReturn});
+    }
+}
+
+uint32_t KeywordTable::hash(std::string_view word, uint32_t seed)
+{
+    // FNV-1a with the seed mixed into the offset basis
+    uint32_t res = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (const char c : word) {
+        res = (res ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return res ^ (res >> 16);
+}
+
+size_t KeywordTable::getBucket(std::string_view word) const
+{
+    return hash(word, UINT32_MAX) % bucketSeeds.size();
+}
+
+size_t KeywordTable::getSlot(std::string_view word, uint32_t seed) const
+{
+    return hash(word, seed) & (slots.size() - 1);
+}
+
+std::optional<TerminalSymbol> KeywordTable::find(std::string_view word) const
+{
+    if (slots.empty()) {
+        return std::nullopt;
+    }
+    const auto &slot = slots[getSlot(word, bucketSeeds[getBucket(word)])];
+    return !slot.keyword.empty() && slot.keyword == word ? std::make_optional(slot.tokenToReturn)
+                                                         : std::nullopt;
+}
+
+size_t KeywordTable::getSlotsCount() const
+{
+    return slots.size();
+}
+
+void KeywordTable::writeTable(std::ostream &stream, std::string_view name) const
+{
+    // zero-sized arrays aren't allowed, so an empty table gets a dummy element
+    stream << "namespace {\n\n";
+    stream << "constexpr uint32_t keywordBucketSeeds[" << std::max<size_t>(bucketSeeds.size(), 1)
+           << "] = {";
+    for (const auto seed : bucketSeeds) {
+        stream << seed << ", ";
+    }
+    stream << "};\n\n";
+    stream << "constexpr KeywordTable::Entry keywordSlots[" << std::max<size_t>(slots.size(), 1)
+           << "] = {\n";
+    for (const auto &slot : slots) {
+        ASSERT(slot.keyword.find_first_of("\"\\") == std::string::npos);
+        stream << "    {\"" << slot.keyword << "\", TerminalSymbol::"
+               << magic_enum::enum_name(slot.tokenToReturn) << "},\n";
+    }
+    if (slots.empty()) {
+        stream << "    {\"\", TerminalSymbol::ERROR},\n";
+    }
+    stream << "};\n\n";
+    stream << "} // namespace\n\n";
+    stream << "extern const KeywordTable::Table " << name << ";\n";
+    stream << "const KeywordTable::Table " << name << " = {std::span(keywordBucketSeeds, "
+           << bucketSeeds.size() << "), std::span(keywordSlots, " << slots.size() << ")};\n";
+}
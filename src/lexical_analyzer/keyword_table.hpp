@@ -0,0 +1,62 @@
+#ifndef KEYWORD_TABLE_HPP
+#define KEYWORD_TABLE_HPP
+
+#include "symbols.hpp"
+
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Classifies the words matched by the identifier rule as keywords using a perfect hash (hash and
+ * displace): the words are spread into small buckets first and every bucket gets a seed for the
+ * second hash, which was searched so that no two keywords share a slot. A lookup is two hashes
+ * and a single comparison, and the keywords don't take any states of the automaton.
+ */
+class KeywordTable
+{
+public:
+    struct Entry
+    {
+        // empty for a free slot
+        std::string_view keyword;
+        TerminalSymbol tokenToReturn;
+    };
+
+    // views into a table that was built before, usually generated by writeTable
+    struct Table
+    {
+        std::span<const uint32_t> bucketSeeds;
+        // the count is a power of 2
+        std::span<const Entry> slots;
+    };
+
+    KeywordTable() = default;
+    explicit KeywordTable(const std::vector<std::pair<std::string, TerminalSymbol>> &keywords);
+    explicit KeywordTable(const Table &table);
+
+    std::optional<TerminalSymbol> find(std::string_view word) const;
+    size_t getSlotsCount() const;
+
+    // writes a C++ definition of "const KeywordTable::Table <name>"
+    void writeTable(std::ostream &stream, std::string_view name) const;
+
+private:
+    struct Slot
+    {
+        std::string keyword;
+        TerminalSymbol tokenToReturn = TerminalSymbol::ERROR;
+    };
+
+    static uint32_t hash(std::string_view word, uint32_t seed);
+    size_t getBucket(std::string_view word) const;
+    size_t getSlot(std::string_view word, uint32_t seed) const;
+
+    std::vector<uint32_t> bucketSeeds;
+    std::vector<Slot> slots;
+};
+
+#endif // KEYWORD_TABLE_HPP
@@ -0,0 +1,118 @@
+#include "lazy_dfa_constructor.hpp"
+#include "log.hpp"
+
+LazyDfaConstructor::LazyDfaConstructor(size_t maxCachedStates_)
+    : maxCachedStates(maxCachedStates_)
+{
+    // the dead, the start, the current and the next states are needed to make a step
+    ASSERT(maxCachedStates >= 4);
+}
+
+LazyDfaConstructor::LazyDfaConstructor(const LazyDfaConstructor &other)
+    : ThompsonConstructor(other), maxCachedStates(other.maxCachedStates)
+{
+}
+
+LazyDfaConstructor::~LazyDfaConstructor() {}
+
+std::unique_ptr<LexicalAnalyzerConstructor> LazyDfaConstructor::clone()
+{
+    return std::make_unique<LazyDfaConstructor>(*this);
+}
+
+void LazyDfaConstructor::addRule(std::string rule, TerminalSymbol tokenToReturn)
+{
+    ThompsonConstructor::addRule(std::move(rule), tokenToReturn);
+    cachedStates.clear();
+    statesVertices.clear();
+    transitions.clear();
+    acceptingTokens.clear();
+}
+
+size_t LazyDfaConstructor::getCachedStatesCount() const
+{
+    return acceptingTokens.size();
+}
+
+size_t LazyDfaConstructor::getFlushesCount() const
+{
+    return flushesCount;
+}
+
+void LazyDfaConstructor::flush()
+{
+    cachedStates.clear();
+    statesVertices.clear();
+    transitions.clear();
+    acceptingTokens.clear();
+    addState({});
+    startState = addState(automaton.epsClosure({*startVertice}));
+}
+
+LazyDfaConstructor::DfaState LazyDfaConstructor::addState(VerticesSet vertices)
+{
+    const auto [it, wasInserted] =
+        cachedStates.try_emplace(std::move(vertices), static_cast<DfaState>(cachedStates.size()));
+    if (wasInserted) {
+        const auto winner = automaton.getWinningVertice(it->first);
+        statesVertices.push_back(&it->first);
+        transitions.resize(transitions.size() + alphabetSize, unknownState);
+        acceptingTokens.push_back(winner ? std::make_optional(winner->tokenToReturn)
+                                         : std::nullopt);
+    }
+    return it->second;
+}
+
+LazyDfaConstructor::DfaState LazyDfaConstructor::computeTransition(DfaState &state, uint8_t byte)
+{
+    VerticesSet moves;
+    for (const auto vertice : *statesVertices[state]) {
+        for (auto transIndex = automaton.vertices[vertice].firstTransition;
+             transIndex != Transition::noTransition;
+             transIndex = automaton.transitions[transIndex].nextTransition) {
+            const auto &trans = automaton.transitions[transIndex];
+            if (trans.symbol.matches(static_cast<char>(byte), automaton.charSets)) {
+                moves.push_back(trans.dstVertice);
+            }
+        }
+    }
+    auto nextVertices = automaton.epsClosure(moves);
+
+    if (!cachedStates.contains(nextVertices) && cachedStates.size() == maxCachedStates) {
+        // the current state is created again right after the flush, so the match goes on
+        VerticesSet stateVertices = *statesVertices[state];
+        flush();
+        ++flushesCount;
+        state = addState(std::move(stateVertices));
+    }
+    const DfaState nextState = addState(std::move(nextVertices));
+    transitions[state * alphabetSize + byte] = nextState;
+    return nextState;
+}
+
+LexicalMatch LazyDfaConstructor::matchLongest(std::string_view str)
+{
+    LexicalMatch match;
+    if (!startVertice) {
+        return match;
+    }
+    if (acceptingTokens.empty()) {
+        flush();
+    }
+
+    DfaState state = startState;
+    for (size_t i = 0; i < str.size() && state != deadState; ++i) {
+        const auto byte = static_cast<uint8_t>(str[i]);
+        DfaState nextState = transitions[state * alphabetSize + byte];
+        if (nextState == unknownState) {
+            nextState = computeTransition(state, byte);
+        }
+        state = nextState;
+        if (const auto &acceptingToken = acceptingTokens[state]) {
+            match.length = i + 1;
+            match.tokenToReturn = *acceptingToken;
+        }
+    }
+    match.isInputExhausted = state != deadState;
+    return match;
+}
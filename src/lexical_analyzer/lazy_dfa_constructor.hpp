@@ -0,0 +1,59 @@
+#ifndef LAZY_DFA_CONSTRUCTOR_HPP
+#define LAZY_DFA_CONSTRUCTOR_HPP
+
+#include "thompson_constructor.hpp"
+
+#include <map>
+
+/*
+ * Builds the rules using Thompson construction, but unlike DfaConstructor the DFA states are
+ * created from the sets of NFA vertices only when the input reaches them. The states are kept in
+ * a cache of a fixed size, when it is full the cache is flushed and the states are created again.
+ * The hot paths run at the DFA speed, while the memory stays bounded even when the full DFA
+ * would be huge.
+ */
+class LazyDfaConstructor : public ThompsonConstructor
+{
+public:
+    static constexpr size_t defaultMaxCachedStates = 1024;
+
+    // a state takes about 1 KB for its transitions plus its set of vertices
+    explicit LazyDfaConstructor(size_t maxCachedStates_ = defaultMaxCachedStates);
+    // the cached states aren't copied, the copy creates its own ones
+    LazyDfaConstructor(const LazyDfaConstructor &other);
+    ~LazyDfaConstructor() override;
+
+    void addRule(std::string rule, TerminalSymbol tokenToReturn) override;
+    std::unique_ptr<LexicalAnalyzerConstructor> clone() override;
+
+    // the dead state is counted as well
+    size_t getCachedStatesCount() const;
+    size_t getFlushesCount() const;
+
+protected:
+    LexicalMatch matchLongest(std::string_view str) override;
+
+private:
+    using DfaState = uint32_t;
+    static constexpr size_t alphabetSize = 256;
+    static constexpr DfaState deadState = 0;
+    // the transition wasn't computed yet
+    static constexpr DfaState unknownState = UINT32_MAX;
+
+    // drops all the states except the dead one and creates the start state again
+    void flush();
+    DfaState addState(VerticesSet vertices);
+    // the state can be renumbered if the cache is flushed meanwhile
+    DfaState computeTransition(DfaState &state, uint8_t byte);
+
+    const size_t maxCachedStates;
+    size_t flushesCount = 0;
+    DfaState startState = deadState;
+    std::map<VerticesSet, DfaState> cachedStates;
+    std::vector<const VerticesSet *> statesVertices;
+    // transitions[state * alphabetSize + byte]
+    std::vector<DfaState> transitions;
+    std::vector<std::optional<TerminalSymbol>> acceptingTokens;
+};
+
+#endif // LAZY_DFA_CONSTRUCTOR_HPP
@@ -0,0 +1,31 @@
+#include "log.hpp"
+#include "scheme_rules.hpp"
+
+#include <fstream>
+#include <sstream>
+
+// builds the DFA and the keyword table of the Scheme rules and writes them as C++ source into the
+// given file
+int main(int argc, char *argv[])
+{
+    ASSERT(argc == 2);
+    DfaConstructor constructor;
+    addSchemeRules(constructor);
+
+    std::stringstream tables;
+    tables << "// generated by lexer_tables_generator, don't edit\n";
+    tables << "#include \"lexical_analyzer/scheme_rules.hpp\"\n\n";
+    constructor.writeTables(tables, "schemeDfaTables");
+    tables << "\n";
+    KeywordTable(getSchemeKeywords()).writeTable(tables, "schemeKeywordTable");
+    // the file is only rewritten when the tables changed, so the library isn't rebuilt needlessly
+    std::ifstream oldFile(argv[1]);
+    std::stringstream oldTables;
+    oldTables << oldFile.rdbuf();
+    if (oldTables.str() != tables.str()) {
+        std::ofstream file(argv[1]);
+        file << tables.str();
+        ASSERT_MSG(file, "Can't write the lexer tables");
+    }
+    return 0;
+}
@@ -1,10 +1,9 @@
 #include "lexical_analyzer.hpp"
+#include "token_stream.hpp"
 
-struct LexicalVertice
-{
-    std::vector<Transition> transitions;
-    bool isAccepting = false;
-};
+#include <algorithm>
+#include <array>
+#include <stack>
 
 LexicalAnalyzerConstructor::~LexicalAnalyzerConstructor() {}
 
@@ -13,49 +12,152 @@ LexicalAnalyzer::LexicalAnalyzer(std::shared_ptr<LexicalAnalyzerConstructor> con
 {
 }
 
-static std::pair<size_t, bool> matchMaxRule(std::string_view str, LexicalVertice *vertice)
+VerticeIndex LexicalAutomaton::addVertice()
+{
+    vertices.emplace_back();
+    return static_cast<VerticeIndex>(vertices.size() - 1);
+}
+
+void LexicalAutomaton::addTransition(VerticeIndex from, VerticeIndex to, TransitionSymbol symbol)
+{
+    transitions.push_back(Transition{to, vertices[from].firstTransition, symbol});
+    vertices[from].firstTransition = static_cast<TransitionIndex>(transitions.size() - 1);
+}
+
+VerticesSet LexicalAutomaton::epsClosure(const VerticesSet &toClose)
+{
+    if (visitedMarks.size() != vertices.size() || ++visitedGeneration == 0) {
+        visitedMarks.assign(vertices.size(), 0);
+        visitedGeneration = 1;
+    }
+
+    VerticesSet res;
+    std::stack<VerticeIndex> toCheck;
+    for (const auto vertice : toClose) {
+        if (visitedMarks[vertice] != visitedGeneration) {
+            visitedMarks[vertice] = visitedGeneration;
+            toCheck.push(vertice);
+        }
+    }
+
+    while (!toCheck.empty()) {
+        const auto vertice = toCheck.top();
+        toCheck.pop();
+        res.push_back(vertice);
+        for (auto transIndex = vertices[vertice].firstTransition;
+             transIndex != Transition::noTransition;
+             transIndex = transitions[transIndex].nextTransition) {
+            const auto &trans = transitions[transIndex];
+            if (trans.symbol.kind == TransitionSymbol::Kind::EPS &&
+                visitedMarks[trans.dstVertice] != visitedGeneration) {
+                visitedMarks[trans.dstVertice] = visitedGeneration;
+                toCheck.push(trans.dstVertice);
+            }
+        }
+    }
+
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+const LexicalVertice *LexicalAutomaton::getWinningVertice(const VerticesSet &toCheck) const
+{
+    const LexicalVertice *winner = nullptr;
+    for (const auto verticeIndex : toCheck) {
+        const auto &vertice = vertices[verticeIndex];
+        if (vertice.isAccepting && (!winner || vertice.ruleIndex < winner->ruleIndex)) {
+            winner = &vertice;
+        }
+    }
+    return winner;
+}
+
+LexicalMatch LexicalAnalyzerConstructor::matchLongest(std::string_view str)
 {
-    bool isMatched = vertice->isAccepting;
-    size_t mx = 0;
-    for (auto &trans : vertice->transitions) {
-        const bool isEPS = std::holds_alternative<Transition::EPS>(trans.symbol);
-        const bool isANY = std::holds_alternative<Transition::ANY>(trans.symbol);
-        auto doesCharMatch = [&](Transition::Symbol transSymbol, char toMatch) {
-            const char *charSymbol = std::get_if<char>(&transSymbol);
-            return charSymbol && *charSymbol == toMatch;
-        };
-        if (isEPS || (str.size() > 0 && (doesCharMatch(trans.symbol, str[0]) || isANY))) {
-            const auto res = matchMaxRule(str.substr(!isEPS), trans.dstVertice);
-            if (res.second) {
-                mx = std::max(mx, !isEPS + res.first);
-                isMatched = true;
+    LexicalMatch match;
+    if (!startVertice) {
+        return match;
+    }
+
+    // all the rules are simulated at once, so each character is examined only once
+    VerticesSet currVertices = automaton.epsClosure({*startVertice});
+    for (size_t i = 0; i < str.size() && !currVertices.empty(); ++i) {
+        VerticesSet nextVertices;
+        for (const auto vertice : currVertices) {
+            for (auto transIndex = automaton.vertices[vertice].firstTransition;
+                 transIndex != Transition::noTransition;
+                 transIndex = automaton.transitions[transIndex].nextTransition) {
+                const auto &trans = automaton.transitions[transIndex];
+                if (trans.symbol.matches(str[i], automaton.charSets)) {
+                    nextVertices.push_back(trans.dstVertice);
+                }
             }
         }
+        currVertices = automaton.epsClosure(nextVertices);
+        if (const auto winner = automaton.getWinningVertice(currVertices)) {
+            match.length = i + 1;
+            match.tokenToReturn = winner->tokenToReturn;
+        }
     }
+    match.isInputExhausted = !currVertices.empty();
+    return match;
+}
+
+void LexicalAnalyzerConstructor::beginInput(std::string_view, bool) {}
 
-    return {isMatched ? mx : 0, isMatched};
+void LexicalAnalyzerConstructor::setKeywords(TerminalSymbol identifierToken, KeywordTable keywords_)
+{
+    keywordsIdentifierToken = identifierToken;
+    keywords = std::move(keywords_);
+}
+
+LexicalMatch LexicalAnalyzerConstructor::matchToken(std::string_view str)
+{
+    auto match = matchLongest(str);
+    if (match.length != 0 && match.tokenToReturn == keywordsIdentifierToken) {
+        if (const auto keyword = keywords.find(str.substr(0, match.length))) {
+            match.tokenToReturn = *keyword;
+        }
+    }
+    return match;
 }
 
 TerminalSymbolsSt LexicalAnalyzer::parse(std::string toParse)
 {
+    const auto tokenBuffer = tokenize(toParse);
     TerminalSymbolsSt tokens;
-    std::string_view view = toParse;
-    size_t maxRuleMatched = 0;
+    tokens.reserve(tokenBuffer.size());
+    for (size_t i = 0; i < tokenBuffer.size(); ++i) {
+        tokens.push_back(std::make_shared<TerminalSymbolSt>(tokenBuffer.getSymbolType(i),
+                                                            std::string(tokenBuffer.getText(i))));
+    }
+    return tokens;
+}
+
+TokenBuffer LexicalAnalyzer::tokenize(std::string_view source,
+                                      std::set<TerminalSymbol> skippedSymbols)
+{
+    std::array<bool, magic_enum::enum_count<TerminalSymbol>()> isSkipped = {};
+    for (const auto symbol : skippedSymbols) {
+        isSkipped[static_cast<size_t>(symbol)] = true;
+    }
+
+    TokenBuffer tokens(source);
+    constructor->beginInput(source, true);
+    size_t offset = 0;
+    LexicalMatch match;
     do {
-        maxRuleMatched = 0;
-        TerminalSymbol currentToken = TerminalSymbol::ERROR;
-        for (size_t ruleIndex = 0; ruleIndex < constructor->firstVertices.size(); ++ruleIndex) {
-            const size_t curr =
-                matchMaxRule(view, constructor->firstVertices[ruleIndex].first).first;
-            if (curr > maxRuleMatched) {
-                currentToken = constructor->firstVertices[ruleIndex].second;
-                maxRuleMatched = curr;
-            }
+        match = constructor->matchToken(source.substr(offset));
+        if (match.length == 0 || !isSkipped[static_cast<size_t>(match.tokenToReturn)]) {
+            tokens.push(match.tokenToReturn, offset, match.length);
         }
-        tokens.push_back(std::make_shared<TerminalSymbolSt>(
-            currentToken, std::string(view.substr(0, maxRuleMatched))));
-        view = view.substr(maxRuleMatched);
-    } while (view.size() > 0 && maxRuleMatched > 0);
+        offset += match.length;
+    } while (offset < source.size() && match.length > 0);
 
     return tokens;
 }
+
+TokenStream LexicalAnalyzer::stream(std::istream &input, std::set<TerminalSymbol> skippedSymbols)
+{
+    return TokenStream(constructor, input, std::move(skippedSymbols));
+}
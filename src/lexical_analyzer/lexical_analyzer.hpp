@@ -1,22 +1,102 @@
 #ifndef LEXICAL_ANALYZER_HPP
 #define LEXICAL_ANALYZER_HPP
 
+#include "keyword_table.hpp"
 #include "symbols.hpp"
+#include "token_buffer.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <vector>
 
 class LexicalAnalyzer;
-struct LexicalVertice;
+class TokenStream;
 
-struct Transition
+using VerticeIndex = uint32_t;
+using TransitionIndex = uint32_t;
+
+// a set of bytes, is matched by a single transition
+using CharSet = std::bitset<256>;
+using CharSetIndex = uint16_t;
+
+struct TransitionSymbol
 {
-    LexicalVertice *dstVertice;
-    struct EPS
+    enum class Kind : uint8_t
     {
+        EPS,
+        ANY,
+        CHAR,
+        // any byte of the set, the sets are stored apart in the automaton
+        SET
     };
-    struct ANY
+    Kind kind;
+    char symbol = 0;
+    CharSetIndex charSet = 0;
+
+    bool matches(char toMatch, const std::vector<CharSet> &charSets) const
     {
-    };
-    using Symbol = std::variant<EPS, ANY, char>;
-    Symbol symbol;
+        return kind == Kind::ANY || (kind == Kind::CHAR && symbol == toMatch) ||
+               (kind == Kind::SET && charSets[charSet][static_cast<uint8_t>(toMatch)]);
+    }
+};
+
+// the transitions of a vertice are linked into a list inside the arena, so a vertice doesn't own
+// any memory
+struct Transition
+{
+    static constexpr TransitionIndex noTransition = UINT32_MAX;
+
+    VerticeIndex dstVertice;
+    TransitionIndex nextTransition;
+    TransitionSymbol symbol;
+};
+
+struct LexicalVertice
+{
+    TransitionIndex firstTransition = Transition::noTransition;
+    bool isAccepting = false;
+    // rules are numbered in the order they were added, the smallest number wins a tie
+    uint32_t ruleIndex = 0;
+    TerminalSymbol tokenToReturn = TerminalSymbol::ERROR;
+};
+
+// sorted and without duplicates, so it can be compared and used as a key
+using VerticesSet = std::vector<VerticeIndex>;
+
+/*
+ * An arena which owns all the vertices and transitions of an automaton. Vertices and transitions
+ * refer to each other by indices, so the whole automaton is two contiguous arrays that are freed
+ * together with the arena.
+ */
+class LexicalAutomaton
+{
+public:
+    VerticeIndex addVertice();
+    void addTransition(VerticeIndex from, VerticeIndex to, TransitionSymbol symbol);
+
+    VerticesSet epsClosure(const VerticesSet &vertices);
+    // returns the accepting vertice of the rule with the smallest index or nullptr
+    const LexicalVertice *getWinningVertice(const VerticesSet &vertices) const;
+
+    std::vector<LexicalVertice> vertices;
+    std::vector<Transition> transitions;
+    std::vector<CharSet> charSets;
+
+private:
+    // a vertice is visited during the current closure if its mark equals the current generation
+    std::vector<uint32_t> visitedMarks;
+    uint32_t visitedGeneration = 0;
+};
+
+struct LexicalMatch
+{
+    size_t length = 0;
+    TerminalSymbol tokenToReturn = TerminalSymbol::ERROR;
+    // the automaton was still alive when the input ended, so more input may give a longer match
+    bool isInputExhausted = false;
 };
 
 enum class MetaRuleSymbol
@@ -37,35 +117,61 @@ public:
 
     virtual void addRule(std::string rule, TerminalSymbol tokenToReturn) = 0;
     virtual void addRules(std::vector<std::string> rules, TerminalSymbol tokenToReturn) = 0;
+    // an independent copy with the same rules, so the copies can match on different threads
+    virtual std::unique_ptr<LexicalAnalyzerConstructor> clone() = 0;
+    // the tokens of identifierToken type are looked up in the keywords after matching, so the
+    // keywords don't need rules of their own
+    void setKeywords(TerminalSymbol identifierToken, KeywordTable keywords_);
 
-    // TODO: this is ugly
-    inline static const std::string allLetters =
-        "[abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ]";
-    inline static const std::string allDigits = "[0123456789]";
-    inline static const std::string allLettersDigits = "[" + allLetters + allDigits + "]";
-    inline static const std::string allLettersDigitsSpace = "[" + allLettersDigits + " ]";
-    inline static const std::string everything = "[" + allLettersDigitsSpace +
-                                                 "(\\\\)"
-                                                 "(\\[)"
-                                                 "(\\])"
-                                                 "(\\*)"
-                                                 "(\\+)"
-                                                 "(\\()"
-                                                 "(\\))"
-                                                 "/"
-                                                 "]";
+    inline static const std::string allLetters = "[a-zA-Z]";
+    inline static const std::string allDigits = "[0-9]";
+    inline static const std::string allLettersDigits = "[a-zA-Z0-9]";
+    inline static const std::string allLettersDigitsSpace = "[a-zA-Z0-9 ]";
+    inline static const std::string everything = "[a-zA-Z0-9 \\\\\\[\\]\\*\\+\\(\\)/]";
 
 protected:
     friend LexicalAnalyzer;
-    std::vector<std::pair<LexicalVertice *, TerminalSymbol>> firstVertices;
+    friend TokenStream;
+    // returns the length of the longest prefix of str matched by any rule and the token of the
+    // rule that was added first among the matched ones, the length is 0 if nothing matched
+    virtual LexicalMatch matchLongest(std::string_view str);
+    // matchLongest with the keywords classified
+    LexicalMatch matchToken(std::string_view str);
+    // the suffixes of the input are matched until the next call, so what a constructor learns
+    // about the input while matching one token can be reused for the following ones, the input
+    // isn't complete when more of it can be given by the next call
+    virtual void beginInput(std::string_view input, bool isComplete);
+
+    // stays empty for constructors that don't build an NFA
+    LexicalAutomaton automaton;
+    // all the rules are reachable by epsilon transitions from this vertice
+    std::optional<VerticeIndex> startVertice;
+    uint32_t rulesCount = 0;
+
+private:
+    std::optional<TerminalSymbol> keywordsIdentifierToken;
+    KeywordTable keywords;
 };
 
 class LexicalAnalyzer
 {
 public:
+    static constexpr size_t defaultChunkSize = 4 * 1024 * 1024;
+
     LexicalAnalyzer(std::shared_ptr<LexicalAnalyzerConstructor> constructor_);
 
     TerminalSymbolsSt parse(std::string toParse);
+    // tokens of skippedSymbols types are dropped while scanning, the source has to outlive the
+    // returned buffer
+    TokenBuffer tokenize(std::string_view source, std::set<TerminalSymbol> skippedSymbols = {});
+    // gives the same tokens as tokenize, but the source is split into chunks of about chunkSize
+    // bytes after newlines which are lexed on threadsCount threads (all the hardware threads if
+    // it's 0), a chunk starting inside a token is resynchronised while the chunks are joined
+    TokenBuffer tokenizeParallel(std::string_view source,
+                                 std::set<TerminalSymbol> skippedSymbols = {},
+                                 size_t threadsCount = 0, size_t chunkSize = defaultChunkSize);
+    // produces the tokens on demand while reading the input, see TokenStream
+    TokenStream stream(std::istream &input, std::set<TerminalSymbol> skippedSymbols = {});
 
 private:
     const std::shared_ptr<LexicalAnalyzerConstructor> constructor;
@@ -0,0 +1,128 @@
+#include "lexical_analyzer.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+
+/*
+ * The chunks are lexed independently from their beginnings, the last token of a chunk may run
+ * into the next chunk. A chunk can start inside a token (a string or a comment with a newline),
+ * then its first tokens are wrong. Since lexing from a position where a token starts always gives
+ * the same tokens, the tokens of a chunk are right from the first one which starts where a token
+ * of the previous chunks ends. So the chunks are joined in order and the tokens are lexed once
+ * again only until the lexing meets a token start of the chunk.
+ */
+
+// the beginning of the first line starting at position or after it
+static size_t getLineBegin(std::string_view source, size_t position)
+{
+    const auto newline = source.find('\n', position);
+    return newline == std::string_view::npos ? source.size() : newline + 1;
+}
+
+// returns the index of the token starting at offset or std::nullopt if there is no such token
+static std::optional<size_t> findTokenAt(const TokenBuffer &tokens, size_t offset)
+{
+    size_t low = 0, high = tokens.size();
+    while (low < high) {
+        const size_t middle = (low + high) / 2;
+        if (tokens.getOffset(middle) < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < tokens.size() && tokens.getOffset(low) == offset) {
+        return low;
+    }
+    return std::nullopt;
+}
+
+TokenBuffer LexicalAnalyzer::tokenizeParallel(std::string_view source,
+                                              std::set<TerminalSymbol> skippedSymbols,
+                                              size_t threadsCount, size_t chunkSize)
+{
+    ASSERT(chunkSize > 0);
+    std::vector<size_t> chunkBegins = {0};
+    for (size_t position = chunkSize; position < source.size(); position += chunkSize) {
+        const size_t lineBegin = getLineBegin(source, std::max(position, chunkBegins.back()));
+        if (lineBegin < source.size()) {
+            chunkBegins.push_back(lineBegin);
+        }
+    }
+    if (chunkBegins.size() == 1) {
+        return tokenize(source, std::move(skippedSymbols));
+    }
+    chunkBegins.push_back(source.size());
+    const size_t chunksCount = chunkBegins.size() - 1;
+
+    if (threadsCount == 0) {
+        threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadsCount = std::min(threadsCount, chunksCount);
+
+    // the constructors keep the state of the current input, so every thread needs its own one
+    std::vector<TokenBuffer> chunksTokens(chunksCount, TokenBuffer(source));
+    std::atomic<size_t> nextChunk = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount);
+    for (size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back([&, threadConstructor = constructor->clone()]() {
+            for (size_t chunk = nextChunk++; chunk < chunksCount; chunk = nextChunk++) {
+                // the last token starts before the next chunk, but may end after its beginning
+                threadConstructor->beginInput(source.substr(chunkBegins[chunk]), true);
+                size_t offset = chunkBegins[chunk];
+                LexicalMatch match;
+                do {
+                    match = threadConstructor->matchToken(source.substr(offset));
+                    chunksTokens[chunk].push(match.tokenToReturn, offset, match.length);
+                    offset += match.length;
+                } while (offset < chunkBegins[chunk + 1] && match.length > 0);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::array<bool, magic_enum::enum_count<TerminalSymbol>()> isSkipped = {};
+    for (const auto symbol : skippedSymbols) {
+        isSkipped[static_cast<size_t>(symbol)] = true;
+    }
+
+    TokenBuffer tokens(source);
+    constructor->beginInput(source, true);
+    size_t offset = 0, chunk = 0;
+    while (offset < source.size()) {
+        while (chunkBegins[chunk + 1] <= offset) {
+            ++chunk;
+        }
+        const auto &chunkTokens = chunksTokens[chunk];
+        size_t length = 0;
+        if (const auto first = findTokenAt(chunkTokens, offset)) {
+            for (size_t i = *first; i < chunkTokens.size(); ++i) {
+                const auto symbolType = chunkTokens.getSymbolType(i);
+                length = chunkTokens.getText(i).size();
+                if (length == 0 || !isSkipped[static_cast<size_t>(symbolType)]) {
+                    tokens.push(symbolType, chunkTokens.getOffset(i), length);
+                }
+            }
+            offset = chunkTokens.getOffset(chunkTokens.size() - 1) + length;
+        } else {
+            // the chunk isn't synchronised yet, the tokens are lexed until it is
+            const auto match = constructor->matchToken(source.substr(offset));
+            length = match.length;
+            if (length == 0 || !isSkipped[static_cast<size_t>(match.tokenToReturn)]) {
+                tokens.push(match.tokenToReturn, offset, length);
+            }
+            offset += length;
+        }
+        if (length == 0) {
+            break;
+        }
+    }
+
+    return tokens;
+}
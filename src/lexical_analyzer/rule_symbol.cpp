@@ -0,0 +1,193 @@
+#include "rule_symbol.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <limits>
+
+RuleSymbol getNextRuleSymbol(std::string_view &rule_view)
+{
+    RuleSymbol ret = {std::monostate(), 0};
+    if (rule_view.size() == 0) {
+        ret = {std::monostate(), 0};
+    } else if (rule_view[0] == '\\') {
+        if (rule_view.size() > 1) {
+            ret = {rule_view[1], 2};
+        }
+    } else {
+        switch (rule_view[0]) {
+            case '(': {
+                ret = {MetaRuleSymbol::PARENTHESIS_OPEN, 1};
+                break;
+            }
+            case ')': {
+                ret = {MetaRuleSymbol::PARENTHESIS_CLOSE, 1};
+                break;
+            }
+            case '[': {
+                ret = {MetaRuleSymbol::BRACKET_OPEN, 1};
+                break;
+            }
+            case ']': {
+                ret = {MetaRuleSymbol::BRACKET_CLOSE, 1};
+                break;
+            }
+            case '.': {
+                ret = {MetaRuleSymbol::DOT, 1};
+                break;
+            }
+            case '*': {
+                ret = {MetaRuleSymbol::ASTERIX, 1};
+                break;
+            }
+            case '+': {
+                ret = {MetaRuleSymbol::PLUS, 1};
+                break;
+            }
+            default: {
+                ret = {rule_view[0], 1};
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+bool isRuleSymbolValid(RuleSymbol ruleSymbol)
+{
+    return !std::holds_alternative<std::monostate>(ruleSymbol.symbol);
+}
+
+bool doesSubregexLastSymbolMatch(RuleSymbol lastSymbol, SubregexType subregexType)
+{
+    if (const MetaRuleSymbol *metaRuleSymbol = std::get_if<MetaRuleSymbol>(&lastSymbol.symbol)) {
+        switch (*metaRuleSymbol) {
+            case MetaRuleSymbol::PARENTHESIS_CLOSE: {
+                return subregexType == SubregexType::GROUP;
+            }
+            case MetaRuleSymbol::BRACKET_CLOSE: {
+                return subregexType == SubregexType::UNION;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+static bool isQuantifier(const RuleSymbol &ruleSymbol)
+{
+    const MetaRuleSymbol *metaRuleSymbol = std::get_if<MetaRuleSymbol>(&ruleSymbol.symbol);
+    return metaRuleSymbol &&
+           (*metaRuleSymbol == MetaRuleSymbol::ASTERIX || *metaRuleSymbol == MetaRuleSymbol::PLUS);
+}
+
+// a single character element of a union: a character, a range, a dot or a union of them
+static std::optional<CharClass> getCharClassElement(std::string_view rule)
+{
+    if (const auto range = getCharRange(rule)) {
+        return range;
+    }
+    const auto ruleSymbol = getNextRuleSymbol(rule);
+    if (const char *charSymbol = std::get_if<char>(&ruleSymbol.symbol)) {
+        CharSet chars;
+        chars.set(static_cast<uint8_t>(*charSymbol));
+        return CharClass{chars, ruleSymbol.width};
+    } else if (const MetaRuleSymbol *metaRuleSymbol =
+                   std::get_if<MetaRuleSymbol>(&ruleSymbol.symbol)) {
+        switch (*metaRuleSymbol) {
+            case MetaRuleSymbol::DOT: {
+                return CharClass{CharSet().set(), 1};
+            }
+            case MetaRuleSymbol::BRACKET_OPEN: {
+                return getCharClass(rule);
+            }
+            case MetaRuleSymbol::PARENTHESIS_OPEN: {
+                // a group of a single element without a quantifier
+                auto element = getCharClassElement(rule.substr(1));
+                if (!element) {
+                    return std::nullopt;
+                }
+                std::string_view groupTail = rule.substr(1 + element->width);
+                if (!doesSubregexLastSymbolMatch(getNextRuleSymbol(groupTail),
+                                                 SubregexType::GROUP)) {
+                    return std::nullopt;
+                }
+                element->width += 2;
+                return element;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<CharClass> getCharClass(std::string_view rule)
+{
+    CharClass charClass{CharSet(), 1};
+    const bool isNegated = rule.size() > 1 && rule[1] == '^';
+    if (isNegated) {
+        ++charClass.width;
+    }
+    for (;;) {
+        std::string_view ruleTail = rule.substr(charClass.width);
+        const auto ruleSymbol = getNextRuleSymbol(ruleTail);
+        if (!isRuleSymbolValid(ruleSymbol)) {
+            return std::nullopt;
+        } else if (doesSubregexLastSymbolMatch(ruleSymbol, SubregexType::UNION)) {
+            ++charClass.width;
+            break;
+        }
+
+        const auto element = getCharClassElement(ruleTail);
+        if (!element) {
+            return std::nullopt;
+        }
+        // a quantified element can match several characters
+        std::string_view elementTail = ruleTail.substr(element->width);
+        if (isQuantifier(getNextRuleSymbol(elementTail))) {
+            return std::nullopt;
+        }
+        charClass.chars |= element->chars;
+        charClass.width += element->width;
+    }
+    if (isNegated) {
+        charClass.chars.flip();
+    }
+    return charClass;
+}
+
+std::optional<CharClass> getCharRange(std::string_view rule)
+{
+    const auto from = getNextRuleSymbol(rule);
+    const char *fromChar = std::get_if<char>(&from.symbol);
+    // an escaped dash is a character
+    if (!fromChar || rule.size() <= from.width || rule[from.width] != '-') {
+        return std::nullopt;
+    }
+    std::string_view toTail = rule.substr(from.width + 1);
+    const auto to = getNextRuleSymbol(toTail);
+    const char *toChar = std::get_if<char>(&to.symbol);
+    if (!toChar || static_cast<uint8_t>(*fromChar) > static_cast<uint8_t>(*toChar)) {
+        return std::nullopt;
+    }
+
+    CharSet chars;
+    for (unsigned c = static_cast<uint8_t>(*fromChar); c <= static_cast<uint8_t>(*toChar); ++c) {
+        chars.set(c);
+    }
+    return CharClass{chars, from.width + 1 + to.width};
+}
+
+TransitionSymbol addCharSet(std::vector<CharSet> &charSets, const CharSet &chars)
+{
+    auto it = std::find(charSets.begin(), charSets.end(), chars);
+    if (it == charSets.end()) {
+        ASSERT(charSets.size() <= std::numeric_limits<CharSetIndex>::max());
+        charSets.push_back(chars);
+        it = std::prev(charSets.end());
+    }
+    return {TransitionSymbol::Kind::SET, 0, static_cast<CharSetIndex>(it - charSets.begin())};
+}
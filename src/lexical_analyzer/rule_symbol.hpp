@@ -0,0 +1,44 @@
+#ifndef RULE_SYMBOL_HPP
+#define RULE_SYMBOL_HPP
+
+#include "lexical_analyzer.hpp"
+
+#include <optional>
+#include <string_view>
+#include <variant>
+
+// the rule syntax is shared by all the constructors, they only differ in what they build from it
+
+enum class SubregexType
+{
+    GROUP, // (...)
+    UNION, // [...]
+    SIMPLE
+};
+
+struct RuleSymbol
+{
+    std::variant<char, MetaRuleSymbol, std::monostate> symbol;
+    size_t width;
+};
+
+RuleSymbol getNextRuleSymbol(std::string_view &rule_view);
+bool isRuleSymbolValid(RuleSymbol ruleSymbol);
+bool doesSubregexLastSymbolMatch(RuleSymbol lastSymbol, SubregexType subregexType);
+
+struct CharClass
+{
+    CharSet chars;
+    size_t width;
+};
+
+// a union which always matches a single character: of characters, ranges (a-z), dots, such
+// unions and groups of one such element, negated if it starts with ^ ([^"]), the rule has to
+// start with the bracket, std::nullopt is returned for other unions
+std::optional<CharClass> getCharClass(std::string_view rule);
+// a range of characters inside a union, like a-z
+std::optional<CharClass> getCharRange(std::string_view rule);
+// the same sets share the index
+TransitionSymbol addCharSet(std::vector<CharSet> &charSets, const CharSet &chars);
+
+#endif // RULE_SYMBOL_HPP
@@ -0,0 +1,35 @@
+#include "scheme_rules.hpp"
+
+void addSchemeRules(LexicalAnalyzerConstructor &constructor)
+{
+    constructor.addRule(";" + LexicalAnalyzerConstructor::everything + "*\n",
+                        TerminalSymbol::COMMENT);
+    constructor.addRule("#[tT]", TerminalSymbol::TRUE_LIT);
+    constructor.addRule("#[fF]", TerminalSymbol::FALSE_LIT);
+    constructor.addRule("\\(", TerminalSymbol::OPEN_BRACKET);
+    constructor.addRule("\\)", TerminalSymbol::CLOSED_BRACKET);
+    constructor.addRule("#\\\\" + LexicalAnalyzerConstructor::allLetters,
+                        TerminalSymbol::CHARACTER);
+    constructor.addRule("\"" + LexicalAnalyzerConstructor::everything + "+\"",
+                        TerminalSymbol::STRING);
+    constructor.addRule("'" + LexicalAnalyzerConstructor::allLettersDigits + "+",
+                        TerminalSymbol::SYMBOL);
+    constructor.addRule(LexicalAnalyzerConstructor::allLetters + "+" +
+                            LexicalAnalyzerConstructor::allLettersDigits + "*",
+                        TerminalSymbol::ID);
+    constructor.addRule("[\\+><(>=)(<=)]", TerminalSymbol::ID);
+    constructor.addRule(LexicalAnalyzerConstructor::allDigits + "+", TerminalSymbol::INT);
+    constructor.addRule(" +", TerminalSymbol::BLANK);
+    constructor.addRule("\n+", TerminalSymbol::NEWLINE);
+    constructor.setKeywords(TerminalSymbol::ID, KeywordTable(getSchemeKeywords()));
+}
+
+const std::vector<std::pair<std::string, TerminalSymbol>> &getSchemeKeywords()
+{
+    static const std::vector<std::pair<std::string, TerminalSymbol>> keywords = {
+        {"define", TerminalSymbol::DEFINE},
+        {"begin", TerminalSymbol::BEGIN},
+        {"if", TerminalSymbol::IF},
+    };
+    return keywords;
+}
@@ -0,0 +1,18 @@
+#ifndef SCHEME_RULES_HPP
+#define SCHEME_RULES_HPP
+
+#include "dfa_constructor.hpp"
+
+// adds the lexer rules and the keywords of the Scheme language, the order of the rules is their
+// priority
+void addSchemeRules(LexicalAnalyzerConstructor &constructor);
+const std::vector<std::pair<std::string, TerminalSymbol>> &getSchemeKeywords();
+
+// the DFA of the Scheme rules and the table of the keywords, generated at build time by
+// lexer_tables_generator
+extern const DfaConstructor::Tables schemeDfaTables;
+extern const KeywordTable::Table schemeKeywordTable;
+// the constructor with the generated tables, nothing is built at runtime
+std::shared_ptr<DfaConstructor> makeSchemeDfaConstructor();
+
+#endif // SCHEME_RULES_HPP
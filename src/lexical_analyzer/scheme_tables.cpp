@@ -0,0 +1,9 @@
+#include "scheme_rules.hpp"
+
+// kept apart from scheme_rules.cpp, because the generator of the tables is built without them
+std::shared_ptr<DfaConstructor> makeSchemeDfaConstructor()
+{
+    auto constructor = std::make_shared<DfaConstructor>(schemeDfaTables);
+    constructor->setKeywords(TerminalSymbol::ID, KeywordTable(schemeKeywordTable));
+    return constructor;
+}
@@ -1,153 +1,72 @@
 #include "thompson_constructor.hpp"
 #include "log.hpp"
+#include "rule_symbol.hpp"
 
 #include <exception>
 #include <stack>
 
-struct LexicalVertice
+ThompsonConstructor::ThompsonConstructor()
 {
-    std::vector<Transition> transitions;
-    bool isAccepting = false;
-};
-
-ThompsonConstructor::ThompsonConstructor() {}
+    startVertice = automaton.addVertice();
+}
 ThompsonConstructor::~ThompsonConstructor() {}
 
-enum class SubregexType
+std::unique_ptr<LexicalAnalyzerConstructor> ThompsonConstructor::clone()
 {
-    GROUP, // (...)
-    UNION, // [...]
-    SIMPLE
-};
-
-struct RuleSymbol
-{
-    std::variant<char, MetaRuleSymbol, std::monostate> symbol;
-    size_t width;
-};
+    return std::make_unique<ThompsonConstructor>(*this);
+}
 
 struct Subregex
 {
-    LexicalVertice *begin = nullptr, *end = nullptr;
+    VerticeIndex begin, end;
     SubregexType subregexType; // is stored to know whether the finishing symbol matches the type
 };
 
 using MaybeSubregex = std::optional<Subregex>;
 
-static inline void addTransition(LexicalVertice *from, LexicalVertice *to,
-                                 Transition::Symbol transSymbol)
-{
-    from->transitions.push_back(Transition{to, transSymbol});
-}
-
-static RuleSymbol getNextRuleSymbol(std::string_view &rule_view)
-{
-    RuleSymbol ret = {std::monostate(), 0};
-    if (rule_view.size() == 0) {
-        ret = {std::monostate(), 0};
-    } else if (rule_view[0] == '\\') {
-        if (rule_view.size() > 1) {
-            ret = {rule_view[1], 2};
-        }
-    } else {
-        switch (rule_view[0]) {
-            case '(': {
-                ret = {MetaRuleSymbol::PARENTHESIS_OPEN, 1};
-                break;
-            }
-            case ')': {
-                ret = {MetaRuleSymbol::PARENTHESIS_CLOSE, 1};
-                break;
-            }
-            case '[': {
-                ret = {MetaRuleSymbol::BRACKET_OPEN, 1};
-                break;
-            }
-            case ']': {
-                ret = {MetaRuleSymbol::BRACKET_CLOSE, 1};
-                break;
-            }
-            case '.': {
-                ret = {MetaRuleSymbol::DOT, 1};
-                break;
-            }
-            case '*': {
-                ret = {MetaRuleSymbol::ASTERIX, 1};
-                break;
-            }
-            case '+': {
-                ret = {MetaRuleSymbol::PLUS, 1};
-                break;
-            }
-            default: {
-                ret = {rule_view[0], 1};
-                break;
-            }
-        }
-    }
-    return ret;
-}
-
-static bool isRuleSymbolValid(RuleSymbol ruleSymbol)
-{
-    return !std::holds_alternative<std::monostate>(ruleSymbol.symbol);
-}
+static const TransitionSymbol epsSymbol = {TransitionSymbol::Kind::EPS};
 
-static inline bool doesSubregexLastSymbolMatch(RuleSymbol lastSymbol, SubregexType subregexType)
-{
-    if (const MetaRuleSymbol *metaRuleSymbol = std::get_if<MetaRuleSymbol>(&lastSymbol.symbol)) {
-        switch (*metaRuleSymbol) {
-            case MetaRuleSymbol::PARENTHESIS_CLOSE: {
-                return subregexType == SubregexType::GROUP;
-            }
-            case MetaRuleSymbol::BRACKET_CLOSE: {
-                return subregexType == SubregexType::UNION;
-            }
-            default: {
-                break;
-            }
-        }
-    }
-    return false;
-}
-
-static std::optional<Subregex> processSubregex(std::string_view &ruleTail);
+static std::optional<Subregex> processSubregex(std::string_view &ruleTail,
+                                             LexicalAutomaton &automaton);
 
-static void processAsteriskQuantifier(std::string_view &ruleTail, Subregex &subregex)
+static void processAsteriskQuantifier(std::string_view &ruleTail, LexicalAutomaton &automaton,
+                                      Subregex &subregex)
 {
     ruleTail = ruleTail.substr(1);
-    auto newBegin = new LexicalVertice(), newEnd = new LexicalVertice();
-    addTransition(newBegin, subregex.begin, Transition::EPS());
-    addTransition(newBegin, newEnd, Transition::EPS());
-    addTransition(subregex.end, subregex.begin, Transition::EPS());
-    addTransition(subregex.end, newEnd, Transition::EPS());
+    const auto newBegin = automaton.addVertice(), newEnd = automaton.addVertice();
+    automaton.addTransition(newBegin, subregex.begin, epsSymbol);
+    automaton.addTransition(newBegin, newEnd, epsSymbol);
+    automaton.addTransition(subregex.end, subregex.begin, epsSymbol);
+    automaton.addTransition(subregex.end, newEnd, epsSymbol);
     subregex.begin = newBegin;
     subregex.end = newEnd;
 }
 
-static void processPlusQuantifier(std::string_view &ruleTail, Subregex &subregex)
+static void processPlusQuantifier(std::string_view &ruleTail, LexicalAutomaton &automaton,
+                                  Subregex &subregex)
 {
     ruleTail = ruleTail.substr(1);
-    auto newBegin = new LexicalVertice(), newEnd = new LexicalVertice();
-    addTransition(newBegin, subregex.begin, Transition::EPS());
-    addTransition(subregex.end, subregex.begin, Transition::EPS());
-    addTransition(subregex.end, newEnd, Transition::EPS());
+    const auto newBegin = automaton.addVertice(), newEnd = automaton.addVertice();
+    automaton.addTransition(newBegin, subregex.begin, epsSymbol);
+    automaton.addTransition(subregex.end, subregex.begin, epsSymbol);
+    automaton.addTransition(subregex.end, newEnd, epsSymbol);
     subregex.begin = newBegin;
     subregex.end = newEnd;
 }
 
-static void processPossibleQuantifier(std::string_view &ruleTail, Subregex &subregex)
+static void processPossibleQuantifier(std::string_view &ruleTail, LexicalAutomaton &automaton,
+                                      Subregex &subregex)
 {
     const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
     if (const MetaRuleSymbol *metaRuleSymbol =
             std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol)) {
         switch (*metaRuleSymbol) {
             case MetaRuleSymbol::ASTERIX: {
-                processAsteriskQuantifier(ruleTail, subregex);
+                processAsteriskQuantifier(ruleTail, automaton, subregex);
                 break;
             }
             case MetaRuleSymbol::PLUS: {
-                processPlusQuantifier(ruleTail, subregex);
+                processPlusQuantifier(ruleTail, automaton, subregex);
                 break;
             }
             default:
@@ -156,32 +75,47 @@ static void processPossibleQuantifier(std::string_view &ruleTail, Subregex &subr
     }
 }
 
-static MaybeSubregex processSimpleSubregex(std::string_view &ruleTail)
+static MaybeSubregex processSimpleSubregex(std::string_view &ruleTail, LexicalAutomaton &automaton)
 {
     const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
     ruleTail = ruleTail.substr(currRuleSymbol.width);
-    auto currSubregexBegin = new LexicalVertice(), currSubregexEnd = new LexicalVertice();
-    addTransition(currSubregexBegin, currSubregexEnd, [&]() -> Transition::Symbol {
+    const auto currSubregexBegin = automaton.addVertice(),
+               currSubregexEnd = automaton.addVertice();
+    automaton.addTransition(currSubregexBegin, currSubregexEnd, [&]() -> TransitionSymbol {
         if (const char *charSymbol = std::get_if<char>(&currRuleSymbol.symbol)) {
-            return *charSymbol;
+            return {TransitionSymbol::Kind::CHAR, *charSymbol};
         } else if (const MetaRuleSymbol *metaSymbol =
                        std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol);
                    *metaSymbol == MetaRuleSymbol::DOT) {
-            return Transition::ANY();
+            return {TransitionSymbol::Kind::ANY};
         }
         SHOULD_NOT_HAPPEN;
         return {};
     }());
     Subregex currSubregex{currSubregexBegin, currSubregexEnd, SubregexType::SIMPLE};
-    processPossibleQuantifier(ruleTail, currSubregex);
+    processPossibleQuantifier(ruleTail, automaton, currSubregex);
     return currSubregex;
 }
 
-static MaybeSubregex processGroupSubregex(std::string_view &ruleTail)
+static MaybeSubregex processCharClassSubregex(std::string_view &ruleTail,
+                                             LexicalAutomaton &automaton, const CharClass &charClass)
+{
+    ruleTail = ruleTail.substr(charClass.width);
+    const auto currSubregexBegin = automaton.addVertice(),
+               currSubregexEnd = automaton.addVertice();
+    automaton.addTransition(currSubregexBegin, currSubregexEnd,
+                            addCharSet(automaton.charSets, charClass.chars));
+    Subregex currSubregex{currSubregexBegin, currSubregexEnd, SubregexType::UNION};
+    processPossibleQuantifier(ruleTail, automaton, currSubregex);
+    return currSubregex;
+}
+
+static MaybeSubregex processGroupSubregex(std::string_view &ruleTail, LexicalAutomaton &automaton)
 {
     ruleTail = ruleTail.substr(1);
-    auto currSubregexBegin = new LexicalVertice(), currSubregexEnd = new LexicalVertice();
-    auto lastChildSubregexEnd = currSubregexBegin;
+    const auto currSubregexBegin = automaton.addVertice(),
+               currSubregexEnd = automaton.addVertice();
+    VerticeIndex lastChildSubregexEnd = currSubregexBegin;
     for (;;) {
         const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
         if (!isRuleSymbolValid(currRuleSymbol)) {
@@ -191,25 +125,34 @@ static MaybeSubregex processGroupSubregex(std::string_view &ruleTail)
             break;
         }
 
-        auto childSubregex = processSubregex(ruleTail);
+        auto childSubregex = processSubregex(ruleTail, automaton);
         if (childSubregex) {
-            addTransition(lastChildSubregexEnd, childSubregex->begin, Transition::EPS());
+            automaton.addTransition(lastChildSubregexEnd, childSubregex->begin, epsSymbol);
             lastChildSubregexEnd = childSubregex->end;
         } else {
             return std::nullopt;
         }
     }
 
-    addTransition(lastChildSubregexEnd, currSubregexEnd, Transition::EPS());
+    automaton.addTransition(lastChildSubregexEnd, currSubregexEnd, epsSymbol);
     Subregex currSubregex{currSubregexBegin, currSubregexEnd, SubregexType::GROUP};
-    processPossibleQuantifier(ruleTail, currSubregex);
+    processPossibleQuantifier(ruleTail, automaton, currSubregex);
     return currSubregex;
 }
 
-static MaybeSubregex processUnionSubregex(std::string_view &ruleTail)
+static MaybeSubregex processUnionSubregex(std::string_view &ruleTail, LexicalAutomaton &automaton)
 {
+    // a union of single characters is a single transition
+    if (const auto charClass = getCharClass(ruleTail)) {
+        return processCharClassSubregex(ruleTail, automaton, *charClass);
+    }
     ruleTail = ruleTail.substr(1);
-    auto currSubregexBegin = new LexicalVertice(), currSubregexEnd = new LexicalVertice();
+    if (!ruleTail.empty() && ruleTail[0] == '^') {
+        // only the unions of single characters can be negated
+        return std::nullopt;
+    }
+    const auto currSubregexBegin = automaton.addVertice(),
+               currSubregexEnd = automaton.addVertice();
     for (;;) {
         const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
         if (!isRuleSymbolValid(currRuleSymbol)) {
@@ -219,36 +162,38 @@ static MaybeSubregex processUnionSubregex(std::string_view &ruleTail)
             break;
         }
 
-        auto childSubregex = processSubregex(ruleTail);
+        const auto charRange = getCharRange(ruleTail);
+        auto childSubregex = charRange ? processCharClassSubregex(ruleTail, automaton, *charRange)
+                                       : processSubregex(ruleTail, automaton);
         if (childSubregex) {
-            addTransition(currSubregexBegin, childSubregex->begin, Transition::EPS());
-            addTransition(childSubregex->end, currSubregexEnd, Transition::EPS());
+            automaton.addTransition(currSubregexBegin, childSubregex->begin, epsSymbol);
+            automaton.addTransition(childSubregex->end, currSubregexEnd, epsSymbol);
         } else {
             return std::nullopt;
         }
     }
 
     Subregex currSubregex{currSubregexBegin, currSubregexEnd, SubregexType::UNION};
-    processPossibleQuantifier(ruleTail, currSubregex);
+    processPossibleQuantifier(ruleTail, automaton, currSubregex);
     return currSubregex;
 }
 
-static MaybeSubregex processSubregex(std::string_view &ruleTail)
+static MaybeSubregex processSubregex(std::string_view &ruleTail, LexicalAutomaton &automaton)
 {
     const auto currRuleSymbol = getNextRuleSymbol(ruleTail);
     if (std::holds_alternative<char>(currRuleSymbol.symbol)) {
-        return processSimpleSubregex(ruleTail);
+        return processSimpleSubregex(ruleTail, automaton);
     } else if (const MetaRuleSymbol *metaRuleSymbol =
                    std::get_if<MetaRuleSymbol>(&currRuleSymbol.symbol)) {
         switch (*metaRuleSymbol) {
             case MetaRuleSymbol::PARENTHESIS_OPEN: {
-                return processGroupSubregex(ruleTail);
+                return processGroupSubregex(ruleTail, automaton);
             }
             case MetaRuleSymbol::BRACKET_OPEN: {
-                return processUnionSubregex(ruleTail);
+                return processUnionSubregex(ruleTail, automaton);
             }
             case MetaRuleSymbol::DOT: {
-                return processSimpleSubregex(ruleTail);
+                return processSimpleSubregex(ruleTail, automaton);
             }
             default: {
                 break;
@@ -262,10 +207,13 @@ void ThompsonConstructor::addRule(std::string rule, TerminalSymbol tokenToReturn
 {
     rule = '(' + rule + ')';
     std::string_view ruleView = rule;
-    MaybeSubregex maybeRegex = processSubregex(ruleView);
+    MaybeSubregex maybeRegex = processSubregex(ruleView, automaton);
     assert(maybeRegex);
-    maybeRegex->end->isAccepting = true;
-    firstVertices.push_back({maybeRegex->begin, tokenToReturn});
+    auto &end = automaton.vertices[maybeRegex->end];
+    end.isAccepting = true;
+    end.ruleIndex = rulesCount++;
+    end.tokenToReturn = tokenToReturn;
+    automaton.addTransition(*startVertice, maybeRegex->begin, epsSymbol);
 }
 
 void ThompsonConstructor::addRules(std::vector<std::string> rules, TerminalSymbol tokenToReturn)
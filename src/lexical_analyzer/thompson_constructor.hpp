@@ -11,6 +11,7 @@ public:
 
     void addRule(std::string rule, TerminalSymbol tokenToReturn) override;
     void addRules(std::vector<std::string> rules, TerminalSymbol tokenToReturn) override;
+    std::unique_ptr<LexicalAnalyzerConstructor> clone() override;
 };
 
 #endif // THOMPSON_ANALYZER_HPP
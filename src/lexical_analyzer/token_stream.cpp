@@ -0,0 +1,67 @@
+#include "token_stream.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+
+TokenStream::TokenStream(std::shared_ptr<LexicalAnalyzerConstructor> constructor_,
+                         std::istream &input_, std::set<TerminalSymbol> skippedSymbols,
+                         size_t bufferSize)
+    : constructor(constructor_), input(input_), buffer(bufferSize)
+{
+    ASSERT(bufferSize > 0);
+    for (const auto symbol : skippedSymbols) {
+        isSkipped[static_cast<size_t>(symbol)] = true;
+    }
+}
+
+void TokenStream::refill()
+{
+    std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+    end -= begin;
+    begin = 0;
+    if (end == buffer.size()) {
+        // the token doesn't fit in the buffer
+        buffer.resize(buffer.size() * 2);
+    }
+
+    input.read(buffer.data() + end, buffer.size() - end);
+    end += input.gcount();
+    isInputOver = !input;
+    constructor->beginInput(std::string_view(buffer.data(), end), isInputOver);
+}
+
+std::optional<Token> TokenStream::next()
+{
+    while (!isErrorReturned) {
+        if (begin == end) {
+            if (isInputOver) {
+                return std::nullopt;
+            }
+            refill();
+            continue;
+        }
+
+        const std::string_view view(buffer.data() + begin, end - begin);
+        const auto match = constructor->matchToken(view);
+        if (match.isInputExhausted && !isInputOver) {
+            // the token may continue in the part of the input which hasn't been read yet
+            refill();
+            continue;
+        }
+
+        if (match.length == 0) {
+            isErrorReturned = true;
+            return Token{TerminalSymbol::ERROR, view.substr(0, 0)};
+        }
+        begin += match.length;
+        if (!isSkipped[static_cast<size_t>(match.tokenToReturn)]) {
+            return Token{match.tokenToReturn, view.substr(0, match.length)};
+        }
+    }
+    return std::nullopt;
+}
+
+bool TokenStream::hasError() const
+{
+    return isErrorReturned;
+}
@@ -0,0 +1,42 @@
+#ifndef TOKEN_STREAM_HPP
+#define TOKEN_STREAM_HPP
+
+#include "lexical_analyzer.hpp"
+
+#include <array>
+#include <istream>
+
+/*
+ * Produces tokens on demand while reading the input through a fixed-size buffer, so the memory
+ * doesn't depend on the size of the input. The buffer only grows when a single token doesn't fit
+ * in it.
+ */
+class TokenStream
+{
+public:
+    static constexpr size_t defaultBufferSize = 64 * 1024;
+
+    TokenStream(std::shared_ptr<LexicalAnalyzerConstructor> constructor_, std::istream &input_,
+                std::set<TerminalSymbol> skippedSymbols = {},
+                size_t bufferSize = defaultBufferSize);
+
+    // returns std::nullopt when the input is over or after an ERROR token was returned,
+    // the text of the token is valid until the next call
+    std::optional<Token> next();
+    bool hasError() const;
+
+private:
+    // moves the unprocessed bytes to the beginning of the buffer and reads more after them
+    void refill();
+
+    const std::shared_ptr<LexicalAnalyzerConstructor> constructor;
+    std::istream &input;
+    std::array<bool, magic_enum::enum_count<TerminalSymbol>()> isSkipped = {};
+
+    std::vector<char> buffer;
+    size_t begin = 0, end = 0;
+    bool isInputOver = false;
+    bool isErrorReturned = false;
+};
+
+#endif // TOKEN_STREAM_HPP
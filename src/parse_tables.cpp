@@ -0,0 +1,147 @@
+#include "parse_tables.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+// the check of a free position of a comb vector
+static constexpr uint32_t noState = UINT32_MAX;
+
+/*
+ * Places the nonzero entries of every row at the first base where they don't collide with the
+ * entries of the rows placed before. The fuller rows are placed first, since they are the hardest
+ * to fit. The vectors are padded, so base + column is inside them for every column.
+ */
+template <class T>
+static void packRows(std::span<const T> table, size_t columnsCount, std::vector<uint32_t> &bases,
+                     std::vector<uint32_t> &checks, std::vector<T> &values)
+{
+    ASSERT(table.size() % columnsCount == 0);
+    const size_t rowsCount = table.size() / columnsCount;
+    std::vector<std::vector<size_t>> rowsColumns(rowsCount);
+    for (size_t row = 0; row < rowsCount; ++row) {
+        for (size_t column = 0; column < columnsCount; ++column) {
+            if (table[row * columnsCount + column] != 0) {
+                rowsColumns[row].push_back(column);
+            }
+        }
+    }
+    std::vector<size_t> rowsOrder(rowsCount);
+    std::iota(rowsOrder.begin(), rowsOrder.end(), 0);
+    std::stable_sort(rowsOrder.begin(), rowsOrder.end(), [&](size_t lhs, size_t rhs) {
+        return rowsColumns[lhs].size() > rowsColumns[rhs].size();
+    });
+
+    bases.assign(rowsCount, 0);
+    checks.clear();
+    size_t maxBase = 0;
+    for (const auto row : rowsOrder) {
+        const auto &columns = rowsColumns[row];
+        if (columns.empty()) {
+            continue;
+        }
+        auto isFree = [&](size_t base) {
+            return std::all_of(columns.begin(), columns.end(), [&](size_t column) {
+                return base + column >= checks.size() || checks[base + column] == noState;
+            });
+        };
+        size_t base = 0;
+        while (!isFree(base)) {
+            ++base;
+        }
+        ASSERT(base + columnsCount <= UINT32_MAX);
+        if (checks.size() < base + columns.back() + 1) {
+            checks.resize(base + columns.back() + 1, noState);
+        }
+        for (const auto column : columns) {
+            checks[base + column] = static_cast<uint32_t>(row);
+        }
+        bases[row] = static_cast<uint32_t>(base);
+        maxBase = std::max(maxBase, base);
+    }
+
+    checks.resize(std::max(checks.size(), maxBase + columnsCount), noState);
+    values.assign(checks.size(), 0);
+    for (size_t i = 0; i < checks.size(); ++i) {
+        if (checks[i] != noState) {
+            values[i] = table[checks[i] * columnsCount + i - bases[checks[i]]];
+        }
+    }
+}
+
+ParseTables::ParseTables(std::span<const ParseAction> denseActions,
+                         std::span<const uint32_t> denseGotos)
+{
+    ASSERT(denseActions.size() % terminalsCount == 0);
+    const size_t statesCount = denseActions.size() / terminalsCount;
+    ASSERT(denseGotos.size() == statesCount * nonTerminalsCount);
+
+    // the reductions which become default are removed from their rows
+    std::vector<ParseAction> explicitActions(denseActions.begin(), denseActions.end());
+    defaultActions.assign(statesCount, 0);
+    for (size_t state = 0; state < statesCount; ++state) {
+        const auto row = std::span(explicitActions).subspan(state * terminalsCount, terminalsCount);
+        ParseAction reduction = 0;
+        bool isSingleReduction = true;
+        for (const auto action : row) {
+            if (action < 0) {
+                isSingleReduction = isSingleReduction && (reduction == 0 || reduction == action);
+                reduction = action;
+            }
+        }
+        if (reduction != 0 && isSingleReduction) {
+            defaultActions[state] = reduction;
+            std::replace(row.begin(), row.end(), reduction, 0);
+        }
+    }
+
+    packRows(std::span<const ParseAction>(explicitActions), terminalsCount, actionBases,
+             actionChecks, actions);
+    packRows(denseGotos, nonTerminalsCount, gotoBases, gotoChecks, gotos);
+}
+
+ParseTables::ParseTables(const Packed &packed)
+    : defaultActions(packed.defaultActions.begin(), packed.defaultActions.end()),
+      actionBases(packed.actionBases.begin(), packed.actionBases.end()),
+      actionChecks(packed.actionChecks.begin(), packed.actionChecks.end()),
+      actions(packed.actions.begin(), packed.actions.end()),
+      gotoBases(packed.gotoBases.begin(), packed.gotoBases.end()),
+      gotoChecks(packed.gotoChecks.begin(), packed.gotoChecks.end()),
+      gotos(packed.gotos.begin(), packed.gotos.end())
+{
+    // the tables are packed for the current symbols, so the rows have to fit into the vectors
+    ASSERT(actionBases.size() == defaultActions.size());
+    ASSERT(gotoBases.size() == defaultActions.size());
+    ASSERT(actionChecks.size() == actions.size() && gotoChecks.size() == gotos.size());
+    for (size_t state = 0; state < defaultActions.size(); ++state) {
+        ASSERT(actionBases[state] + terminalsCount <= actions.size());
+        ASSERT(gotoBases[state] + nonTerminalsCount <= gotos.size());
+    }
+}
+
+ParseAction ParseTables::getAction(uint32_t state, TerminalSymbol terminal) const
+{
+    const size_t index = actionBases[state] + static_cast<size_t>(terminal);
+    return actionChecks[index] == state ? actions[index] : defaultActions[state];
+}
+
+uint32_t ParseTables::getGoto(uint32_t state, NonTerminalSymbol nonTerminal) const
+{
+    const size_t index = gotoBases[state] + static_cast<size_t>(nonTerminal);
+    return gotoChecks[index] == state ? gotos[index] : 0;
+}
+
+size_t ParseTables::getStatesCount() const
+{
+    return defaultActions.size();
+}
+
+size_t ParseTables::getPackedSize() const
+{
+    return actions.size() + gotos.size();
+}
+
+ParseTables::Packed ParseTables::getPacked() const
+{
+    return {defaultActions, actionBases, actionChecks, actions, gotoBases, gotoChecks, gotos};
+}
@@ -0,0 +1,75 @@
+#ifndef PARSE_TABLES_HPP
+#define PARSE_TABLES_HPP
+
+#include "symbols.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// what the parser needs to know about a rule to reduce by it
+struct ParseRule
+{
+    NonTerminalSymbol lhs;
+    uint32_t rhsLength;
+};
+
+/*
+ * An entry of the ACTION table packed into an integer: 0 is an error, a shift to the state s is
+ * s + 1 and a reduction by the rule r is -(r + 1).
+ */
+using ParseAction = int32_t;
+
+/*
+ * The ACTION and GOTO tables compressed for the parser. A state whose reductions are all by the
+ * same rule reduces by it by default: its row keeps only the shifts and any other terminal gives
+ * the reduction instead of an error, so a wrong token is found a few reductions later, but before
+ * it is shifted. The sparse rows are then packed by row displacement into comb vectors: the rows
+ * are overlapped so that their entries don't collide, and the entry of a state and a column is at
+ * base[state] + column if the check of that position is the state.
+ */
+class ParseTables
+{
+public:
+    // views into tables that were packed before, usually generated by writeTables of the analyzer
+    struct Packed
+    {
+        // 0 or the default reduction of every state
+        std::span<const ParseAction> defaultActions;
+        std::span<const uint32_t> actionBases;
+        std::span<const uint32_t> actionChecks;
+        std::span<const ParseAction> actions;
+        std::span<const uint32_t> gotoBases;
+        std::span<const uint32_t> gotoChecks;
+        std::span<const uint32_t> gotos;
+    };
+
+    static constexpr size_t terminalsCount = magic_enum::enum_count<TerminalSymbol>();
+    static constexpr size_t nonTerminalsCount = magic_enum::enum_count<NonTerminalSymbol>();
+
+    ParseTables() = default;
+    // packs the dense tables, actions[state * terminalsCount + terminal] and
+    // gotos[state * nonTerminalsCount + nonterminal], where 0 is an error and no goto
+    ParseTables(std::span<const ParseAction> denseActions, std::span<const uint32_t> denseGotos);
+    explicit ParseTables(const Packed &packed);
+
+    // a terminal without an action gives the default reduction of the state or 0
+    ParseAction getAction(uint32_t state, TerminalSymbol terminal) const;
+    // 0 if the state has no goto by the nonterminal
+    uint32_t getGoto(uint32_t state, NonTerminalSymbol nonTerminal) const;
+    size_t getStatesCount() const;
+    // the entries of both comb vectors
+    size_t getPackedSize() const;
+    Packed getPacked() const;
+
+private:
+    std::vector<ParseAction> defaultActions;
+    std::vector<uint32_t> actionBases;
+    std::vector<uint32_t> actionChecks;
+    std::vector<ParseAction> actions;
+    std::vector<uint32_t> gotoBases;
+    std::vector<uint32_t> gotoChecks;
+    std::vector<uint32_t> gotos;
+};
+
+#endif // PARSE_TABLES_HPP
@@ -0,0 +1,32 @@
+#include "log.hpp"
+#include "scheme_grammar.hpp"
+
+#include <fstream>
+#include <sstream>
+
+// builds the LALR(1) tables of the Scheme grammar and writes them as C++ source into the given
+// file
+int main(int argc, char *argv[])
+{
+    ASSERT(argc == 2);
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                  LrConstruction::LALR1);
+    addSchemeGrammarRules(syntaxAnalyzer);
+    // the tables don't depend on the threads count
+    syntaxAnalyzer.start(0);
+
+    std::stringstream tables;
+    tables << "// generated by parser_tables_generator, don't edit\n";
+    tables << "#include \"scheme_grammar.hpp\"\n\n";
+    syntaxAnalyzer.writeTables(tables, "schemeParseTables");
+    // the file is only rewritten when the tables changed, so the library isn't rebuilt needlessly
+    std::ifstream oldFile(argv[1]);
+    std::stringstream oldTables;
+    oldTables << oldFile.rdbuf();
+    if (oldTables.str() != tables.str()) {
+        std::ofstream file(argv[1]);
+        file << tables.str();
+        ASSERT_MSG(file, "Can't write the parser tables");
+    }
+    return 0;
+}
@@ -224,21 +224,14 @@ AstProgram::SharedPtr convertToAst(NonTerminalSymbolSt::SharedPtr root)
     return processProgram(root);
 }
 
-void removeBlankNewlineTerminals(TerminalSymbolsSt &terminalSymbolsSt)
+bool isLexicalError(const TokenBuffer &tokens)
 {
-    std::erase_if(terminalSymbolsSt, [](auto &symbol) {
-        return symbol->symbolType == TerminalSymbol::BLANK ||
-               symbol->symbolType == TerminalSymbol::NEWLINE ||
-               symbol->symbolType == TerminalSymbol::COMMENT;
-    });
-}
-
-bool isLexicalError(const TerminalSymbolsSt &terminalSymbolsSt)
-{
-    return terminalSymbolsSt.end() !=
-           std::find_if(
-               terminalSymbolsSt.begin(), terminalSymbolsSt.end(),
-               [](const auto &toCheck) { return toCheck->symbolType == TerminalSymbol::ERROR; });
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens.getSymbolType(i) == TerminalSymbol::ERROR) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void stVisitor(const SymbolSt::SharedPtr root,
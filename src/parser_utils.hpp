@@ -3,14 +3,13 @@
 
 #include "ast_node.hpp"
 #include "symbols.hpp"
+#include "token_buffer.hpp"
 
 #include <functional>
 
 // removes from the ST all the nonterminals that are not in the whitelist
 AstProgram::SharedPtr convertToAst(NonTerminalSymbolSt::SharedPtr root);
-// TODO: rename it
-void removeBlankNewlineTerminals(TerminalSymbolsSt &terminalSymbolsSt);
-bool isLexicalError(const TerminalSymbolsSt &terminalSymbolsSt);
+bool isLexicalError(const TokenBuffer &tokens);
 
 void stVisitor(const SymbolSt::SharedPtr root,
                std::function<void(TerminalSymbolSt::SharedPtr)> terminalCallback,
@@ -0,0 +1,73 @@
+#include "scheme_grammar.hpp"
+
+void addSchemeGrammarRules(SyntaxAnalyzer &syntaxAnalyzer)
+{
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROGRAM, {NonTerminalSymbol::STARTS});
+    syntaxAnalyzer.addRules(
+        NonTerminalSymbol::STARTS,
+        {{NonTerminalSymbol::STARTS, NonTerminalSymbol::START}, {NonTerminalSymbol::START}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::START,
+                            {{NonTerminalSymbol::PROCEDURE_DEF}, {NonTerminalSymbol::EXPR}});
+
+    syntaxAnalyzer.addRules(
+        NonTerminalSymbol::EXPRS,
+        {{NonTerminalSymbol::EXPRS, NonTerminalSymbol::EXPR}, {NonTerminalSymbol::EXPR}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::EXPR, {{NonTerminalSymbol::BEGIN_EXPR},
+                                                      {NonTerminalSymbol::VAR_DEF},
+                                                      {TerminalSymbol::ID},
+                                                      {NonTerminalSymbol::LITERAL},
+                                                      {NonTerminalSymbol::PROCEDURE_CALL},
+                                                      {NonTerminalSymbol::COND_IF}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::BEGIN_EXPR,
+                           {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::BEGIN,
+                            NonTerminalSymbol::EXPRS, TerminalSymbol::CLOSED_BRACKET});
+
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROCEDURE_DEF,
+                           {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::DEFINE,
+                            TerminalSymbol::OPEN_BRACKET, TerminalSymbol::ID,
+                            NonTerminalSymbol::PROCEDURE_PARAMS, TerminalSymbol::CLOSED_BRACKET,
+                            NonTerminalSymbol::EXPR, TerminalSymbol::CLOSED_BRACKET});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROCEDURE_DEF,
+                           {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::DEFINE,
+                            TerminalSymbol::OPEN_BRACKET, TerminalSymbol::ID,
+                            TerminalSymbol::CLOSED_BRACKET, NonTerminalSymbol::EXPR,
+                            TerminalSymbol::CLOSED_BRACKET});
+    syntaxAnalyzer.addRules(
+        NonTerminalSymbol::PROCEDURE_PARAMS,
+        {{NonTerminalSymbol::PROCEDURE_PARAMS, NonTerminalSymbol::PROCEDURE_PARAM},
+         {NonTerminalSymbol::PROCEDURE_PARAM}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROCEDURE_PARAM, {TerminalSymbol::ID});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROCEDURE_CALL,
+                           {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::ID,
+                            NonTerminalSymbol::OPERANDS, TerminalSymbol::CLOSED_BRACKET});
+    syntaxAnalyzer.addRule(
+        NonTerminalSymbol::PROCEDURE_CALL,
+        {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::ID, TerminalSymbol::CLOSED_BRACKET});
+    syntaxAnalyzer.addRules(
+        NonTerminalSymbol::OPERANDS,
+        {{NonTerminalSymbol::OPERANDS, NonTerminalSymbol::OPERAND}, {NonTerminalSymbol::OPERAND}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::OPERAND, {NonTerminalSymbol::EXPR});
+
+    syntaxAnalyzer.addRules(
+        NonTerminalSymbol::COND_IF,
+        {{TerminalSymbol::OPEN_BRACKET, TerminalSymbol::IF, NonTerminalSymbol::COND_IF_TEST_EXPR,
+          NonTerminalSymbol::COND_IF_THEN_EXPR, NonTerminalSymbol::COND_IF_ELSE_EXPR,
+          TerminalSymbol::CLOSED_BRACKET},
+         {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::IF, NonTerminalSymbol::COND_IF_TEST_EXPR,
+          NonTerminalSymbol::COND_IF_THEN_EXPR, TerminalSymbol::CLOSED_BRACKET}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::COND_IF_TEST_EXPR, {NonTerminalSymbol::EXPR});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::COND_IF_THEN_EXPR, {NonTerminalSymbol::EXPR});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::COND_IF_ELSE_EXPR, {NonTerminalSymbol::EXPR});
+
+    syntaxAnalyzer.addRule(NonTerminalSymbol::VAR_DEF,
+                           {TerminalSymbol::OPEN_BRACKET, TerminalSymbol::DEFINE,
+                            TerminalSymbol::ID, NonTerminalSymbol::EXPR,
+                            TerminalSymbol::CLOSED_BRACKET});
+
+    syntaxAnalyzer.addRules(NonTerminalSymbol::BOOLEAN,
+                            {{TerminalSymbol::TRUE_LIT}, {TerminalSymbol::FALSE_LIT}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::LITERAL, {{TerminalSymbol::INT},
+                                                         {NonTerminalSymbol::BOOLEAN},
+                                                         {TerminalSymbol::CHARACTER},
+                                                         {TerminalSymbol::STRING}});
+}
@@ -0,0 +1,14 @@
+#ifndef SCHEME_GRAMMAR_HPP
+#define SCHEME_GRAMMAR_HPP
+
+#include "syntax_analyzer.hpp"
+
+// adds the rules of the Scheme grammar, the start symbol is PROGRAM and the end symbol is FINISH
+void addSchemeGrammarRules(SyntaxAnalyzer &syntaxAnalyzer);
+
+// the LALR(1) tables of the Scheme grammar, generated at build time by parser_tables_generator
+extern const SyntaxAnalyzer::Tables schemeParseTables;
+// the parser with the generated tables, the grammar isn't analyzed at runtime
+std::shared_ptr<SyntaxAnalyzer> makeSchemeSyntaxAnalyzer();
+
+#endif // SCHEME_GRAMMAR_HPP
@@ -0,0 +1,7 @@
+#include "scheme_grammar.hpp"
+
+// kept apart from scheme_grammar.cpp, because the generator of the tables is built without them
+std::shared_ptr<SyntaxAnalyzer> makeSchemeSyntaxAnalyzer()
+{
+    return std::make_shared<SyntaxAnalyzer>(schemeParseTables);
+}
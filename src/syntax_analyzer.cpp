@@ -1,27 +1,20 @@
 #include "syntax_analyzer.hpp"
+#include "lexical_analyzer/token_stream.hpp"
 #include "log.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <set>
 #include <sstream>
 #include <stack>
+#include <thread>
 
-Item::Item(Rule rule, size_t tPos, Symbol tLookaheadSymbol)
-    : Rule(std::move(rule)), pos(tPos), lookaheadSymbol(tLookaheadSymbol)
-{
-    ASSERT(pos <= rule.rhs.size());
-}
-
-Item::Item(Item item, size_t tPos) : pos(tPos), lookaheadSymbol(item.lookaheadSymbol)
-{
-    lhs = item.lhs;
-    rhs = item.rhs;
-}
-
-State::State(ItemsSet tItemsSet) : itemsSet(tItemsSet) {}
+State::State(ItemsSet tKernelItems) : kernelItems(std::move(tKernelItems)) {}
 
 std::optional<Decision> State::getDecision(Symbol lookaheadSymbol)
 {
@@ -55,14 +48,32 @@ void State::addGotoState(Symbol lookaheadSymbol, State::SharedPtr state)
     gotoTable[lookaheadSymbol] = state;
 }
 
-SyntaxAnalyzer::SyntaxAnalyzer(NonTerminalSymbol tStartSymbol, TerminalSymbol tEndSymbol)
-    : startSymbol(tStartSymbol), endSymbol(tEndSymbol)
+void State::release()
+{
+    kernelItems = {};
+    decisionTable.clear();
+    gotoTable.clear();
+}
+
+SyntaxAnalyzer::SyntaxAnalyzer(NonTerminalSymbol tStartSymbol, TerminalSymbol tEndSymbol,
+                               LrConstruction tConstruction)
+    : startSymbol(tStartSymbol), endSymbol(tEndSymbol), construction(tConstruction)
+{
+    //
+}
+
+SyntaxAnalyzer::SyntaxAnalyzer(const Tables &tables)
+    : startSymbol(tables.startSymbol), endSymbol(tables.endSymbol),
+      construction(LrConstruction::LALR1), isLoadedFromTables(true),
+      parseRules(tables.rules.begin(), tables.rules.end()),
+      parseTables(tables.parseTables)
 {
     //
 }
 
 void SyntaxAnalyzer::addRule(NonTerminalSymbol lhs, Symbols rhs)
 {
+    ASSERT_MSG(!isLoadedFromTables, "Rules can't be added to the parser loaded from tables");
     allSymbols.merge(SymbolsSet(rhs.begin(), rhs.end()));
     allRulesSet.insert(Rule{lhs, rhs});
 }
@@ -74,251 +85,541 @@ void SyntaxAnalyzer::addRules(NonTerminalSymbol lhs, std::vector<Symbols> rhses)
     }
 }
 
-void SyntaxAnalyzer::start()
+// calls process for the indices from 0 to count on threadsCount threads
+static void runInParallel(size_t count, size_t threadsCount,
+                          const std::function<void(size_t)> &process)
 {
+    threadsCount = std::min(threadsCount, count);
+    if (threadsCount <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            process(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount);
+    for (size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t index = next++; index < count; index = next++) {
+                process(index);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void SyntaxAnalyzer::start(size_t threadsCount)
+{
+    ASSERT_MSG(!isLoadedFromTables, "The parser loaded from tables is already started");
+    rules.assign(allRulesSet.begin(), allRulesSet.end());
+    for (auto &lhsRules : rulesByLhs) {
+        lhsRules.clear();
+    }
+    for (size_t i = 0; i < rules.size(); ++i) {
+        rulesByLhs[static_cast<size_t>(rules[i].lhs)].push_back(i);
+    }
+    computeFirstFollow();
+
+    // the LALR(1) lookaheads are added after the LR(0) automaton is built
+    const uint32_t startLookahead =
+        construction == LrConstruction::LALR1
+            ? Item::noLookahead
+            : static_cast<uint32_t>(std::get<TerminalSymbol>(endSymbol));
     ItemsSet startItemsSet;
-    for (const auto &rule : allRulesSet) {
-        if (rule.lhs == startSymbol) {
-            startItemsSet.insert(Item(rule, 0, endSymbol));
+    for (const auto ruleIndex : rulesByLhs[static_cast<size_t>(startSymbol)]) {
+        startItemsSet.push_back(Item(ruleIndex, 0, startLookahead));
+    }
+
+    if (threadsCount == 0) {
+        threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    /*
+     * The states are built by rounds. The transitions of the states found by the previous round
+     * are computed in parallel, then they are added to the states one by one in the order of the
+     * states. So the states get the same numbers for any threads count.
+     */
+    std::vector<State::SharedPtr> statesToFill = {findOrAddState(std::move(startItemsSet)).first};
+    while (!statesToFill.empty()) {
+        std::vector<StateTransitions> transitions(statesToFill.size());
+        runInParallel(statesToFill.size(), threadsCount,
+                      [&](size_t i) { transitions[i] = computeTransitions(*statesToFill[i]); });
+
+        std::vector<State::SharedPtr> newStates;
+        for (size_t i = 0; i < statesToFill.size(); ++i) {
+            fillStateTables(statesToFill[i], std::move(transitions[i]), newStates);
         }
+        statesToFill = std::move(newStates);
     }
-    startItemsSet = closure(startItemsSet);
-    allItemsSet = startItemsSet;
+    if (construction == LrConstruction::LALR1) {
+        addLalrReductions();
+    }
+    buildParseTables();
 
-    startState = std::make_shared<State>(startItemsSet);
-    allStates.emplace_back(startState);
-    fillStateTables(startState);
+    // only the tables are needed to parse
+    for (auto &state : allStates) {
+        state->release();
+    }
+    allStates = {};
+    statesByHash = {};
+    for (auto &closures : closuresCache) {
+        closures = {};
+    }
+}
+
+size_t SyntaxAnalyzer::getStatesCount() const
+{
+    return parseTables.getStatesCount();
+}
+
+const ParseTables &SyntaxAnalyzer::getParseTables() const
+{
+    return parseTables;
+}
+
+void SyntaxAnalyzer::writeTables(std::ostream &stream, std::string_view name) const
+{
+    ASSERT_MSG(getStatesCount() > 0, "The parse tables weren't built, call start first");
+
+    auto writeArray = [&](std::string_view type, std::string_view arrayName, size_t size,
+                          size_t valuesPerLine, const auto &writeValue) {
+        stream << "constexpr " << type << " " << arrayName << "[" << size << "] = {";
+        for (size_t i = 0; i < size; ++i) {
+            stream << (i % valuesPerLine == 0 ? "\n    " : " ");
+            writeValue(i);
+            stream << ",";
+        }
+        stream << "\n};\n\n";
+    };
+
+    stream << "namespace {\n\n";
+    writeArray("ParseRule", "rules", parseRules.size(), 1, [&](size_t i) {
+        stream << "{NonTerminalSymbol::" << magic_enum::enum_name(parseRules[i].lhs) << ", "
+               << parseRules[i].rhsLength << "}";
+    });
+    auto writeSpan = [&](std::string_view type, std::string_view arrayName, auto values) {
+        writeArray(type, arrayName, values.size(), 16, [&](size_t i) { stream << values[i]; });
+    };
+    const auto packed = parseTables.getPacked();
+    writeSpan("ParseAction", "defaultActions", packed.defaultActions);
+    writeSpan("uint32_t", "actionBases", packed.actionBases);
+    writeSpan("uint32_t", "actionChecks", packed.actionChecks);
+    writeSpan("ParseAction", "actions", packed.actions);
+    writeSpan("uint32_t", "gotoBases", packed.gotoBases);
+    writeSpan("uint32_t", "gotoChecks", packed.gotoChecks);
+    writeSpan("uint32_t", "gotos", packed.gotos);
+    stream << "} // namespace\n\n";
+    stream << "extern const SyntaxAnalyzer::Tables " << name << ";\n";
+    stream << "const SyntaxAnalyzer::Tables " << name << " = {NonTerminalSymbol::"
+           << magic_enum::enum_name(startSymbol) << ", TerminalSymbol::"
+           << magic_enum::enum_name(std::get<TerminalSymbol>(endSymbol))
+           << ", rules,\n    {defaultActions, actionBases, actionChecks, actions, gotoBases, "
+              "gotoChecks, gotos}};\n";
 }
 
 NonTerminalSymbolSt::SharedPtr SyntaxAnalyzer::parse(TerminalSymbolsSt symbols)
 {
-    std::stack<std::pair<State::SharedPtr, SymbolSt::SharedPtr>> statesStack;
-    statesStack.push({startState, nullptr});
+    size_t nextSymbolPos = 0;
+    return parseTokens([&]() -> Token {
+        assert(nextSymbolPos < symbols.size());
+        const auto &symbol = symbols[nextSymbolPos++];
+        return {symbol->symbolType, symbol->text};
+    });
+}
+
+NonTerminalSymbolSt::SharedPtr SyntaxAnalyzer::parse(const TokenBuffer &tokens)
+{
+    size_t nextTokenPos = 0;
+    return parseTokens([&]() -> Token {
+        assert(nextTokenPos < tokens.size());
+        return tokens[nextTokenPos++];
+    });
+}
+
+NonTerminalSymbolSt::SharedPtr SyntaxAnalyzer::parse(TokenStream &tokens)
+{
+    return parseTokens([&]() -> Token {
+        if (auto token = tokens.next()) {
+            return *token;
+        }
+        return {std::get<TerminalSymbol>(endSymbol), ""};
+    });
+}
+
+NonTerminalSymbolSt::SharedPtr
+SyntaxAnalyzer::parseTokens(const std::function<Token()> &getNextToken)
+{
+    ASSERT_MSG(getStatesCount() > 0, "The parse tables weren't built, call start first");
+    std::vector<std::pair<uint32_t, SymbolSt::SharedPtr>> statesStack;
+    statesStack.push_back({0, nullptr});
     size_t currSymbolPos = 0;
+    Token currToken = getNextToken();
 
     while (true) {
         assert(statesStack.size() > 0);
-        assert(currSymbolPos < symbols.size());
-        State::SharedPtr &currState = statesStack.top().first;
-        auto decisionOpt = currState->getDecision(symbols[currSymbolPos]->symbolType);
-        if (!decisionOpt) {
+        const uint32_t currState = statesStack.back().first;
+        const ParseAction action = parseTables.getAction(currState, currToken.symbolType);
+        if (action == 0) {
             std::cerr << "Error during parsing. Can't find what to do. currSymbolPos = "
                       << currSymbolPos << "\n";
             return nullptr;
         }
-        auto decision = *decisionOpt;
 
-        if (auto reduceDecision = tryConvertDecision<ReduceDecision>(decision)) {
-            assert(statesStack.size() > reduceDecision->rhs.size());
-            SymbolsSt symbolsChildren;
-            for (size_t i = 0; i < reduceDecision->rhs.size(); ++i) {
-                assert(statesStack.top().second);
-                symbolsChildren.push_back(statesStack.top().second);
-                statesStack.pop();
+        if (action < 0) {
+            const ParseRule &rule = parseRules[-action - 1];
+            assert(statesStack.size() > rule.rhsLength);
+            SymbolsSt symbolsChildren(rule.rhsLength);
+            for (size_t i = rule.rhsLength; i > 0; --i) {
+                assert(statesStack.back().second);
+                symbolsChildren[i - 1] = std::move(statesStack.back().second);
+                statesStack.pop_back();
             }
 
-            std::reverse(symbolsChildren.begin(), symbolsChildren.end());
             NonTerminalSymbolSt::SharedPtr newSymbolAst =
-                std::make_shared<NonTerminalSymbolSt>(reduceDecision->lhs, symbolsChildren);
-            // for (auto children: symbolsChildren) {
-            //     children->parent = newSymbolAst;
-            // }
-            if (reduceDecision->lhs == startSymbol) {
+                std::make_shared<NonTerminalSymbolSt>(rule.lhs, std::move(symbolsChildren));
+            if (rule.lhs == startSymbol) {
+                // a default reduction can reach the start symbol before the end of the input
                 assert(statesStack.size() == 1);
-                assert(currSymbolPos == symbols.size() - 1);
+                if (Symbol(currToken.symbolType) != endSymbol) {
+                    std::cerr << "Error during parsing. Expected the end of the input. "
+                                 "currSymbolPos = "
+                              << currSymbolPos << "\n";
+                    return nullptr;
+                }
                 return newSymbolAst;
             }
             assert(statesStack.size() > 0);
-            auto nextState = statesStack.top().first->getGotoState(reduceDecision->lhs);
-            statesStack.push({nextState, newSymbolAst});
-        } else if (auto shiftDecision = tryConvertDecision<ShiftDecision>(decision)) {
+            const uint32_t nextState = parseTables.getGoto(statesStack.back().first, rule.lhs);
+            statesStack.push_back({nextState, std::move(newSymbolAst)});
+        } else {
             TerminalSymbolSt::SharedPtr newSymbolAst = std::make_shared<TerminalSymbolSt>(
-                symbols[currSymbolPos]->symbolType, symbols[currSymbolPos]->text);
-            statesStack.push({shiftDecision->state, newSymbolAst});
+                currToken.symbolType, std::string(currToken.text));
+            statesStack.push_back({static_cast<uint32_t>(action - 1), std::move(newSymbolAst)});
             currSymbolPos++;
-        } else {
-            // this should never happen if we process all decision types
-            std::cerr << "Error during parsing. A decision was not proccessed. currSymbolPos = "
-                      << currSymbolPos << "\n";
-            return nullptr;
+            currToken = getNextToken();
         }
     }
 }
 
-SymbolsSet SyntaxAnalyzer::first(Symbols symbols)
+void SyntaxAnalyzer::buildParseTables()
 {
-    SymbolsSet res;
+    std::unordered_map<const State *, uint32_t> stateIndices;
+    for (size_t i = 0; i < allStates.size(); ++i) {
+        stateIndices[allStates[i].get()] = static_cast<uint32_t>(i);
+    }
+    parseRules.clear();
+    for (const auto &rule : rules) {
+        parseRules.push_back({rule.lhs, static_cast<uint32_t>(rule.rhs.size())});
+    }
 
-    for (auto symbol : symbols) {
-        auto currSymbolFirstSet = first(symbol);
-        res.merge(currSymbolFirstSet);
-        if (currSymbolFirstSet.find(EPS) == currSymbolFirstSet.end()) {
-            break;
+    // actionTable[state * terminalsCount + terminal]
+    std::vector<ParseAction> actionTable(allStates.size() * terminalsCount, 0);
+    // gotoTable[state * nonTerminalsCount + nonterminal]
+    std::vector<uint32_t> gotoTable(allStates.size() * nonTerminalsCount, 0);
+    for (size_t stateIndex = 0; stateIndex < allStates.size(); ++stateIndex) {
+        const auto &state = allStates[stateIndex];
+        for (const auto symbol : allSymbols) {
+            if (isTerminal(symbol)) {
+                continue;
+            }
+            if (const auto gotoState = state->getGotoState(symbol)) {
+                gotoTable[stateIndex * nonTerminalsCount +
+                          static_cast<size_t>(std::get<NonTerminalSymbol>(symbol))] =
+                    stateIndices.at(gotoState.get());
+            }
+        }
+        for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+            const auto decision = state->getDecision(static_cast<TerminalSymbol>(terminal));
+            if (!decision) {
+                continue;
+            }
+            ParseAction &action = actionTable[stateIndex * terminalsCount + terminal];
+            if (const auto reduceDecision = tryConvertDecision<ReduceDecision>(*decision)) {
+                action = -static_cast<ParseAction>(reduceDecision->ruleIndex) - 1;
+            } else if (const auto shiftDecision = tryConvertDecision<ShiftDecision>(*decision)) {
+                action = static_cast<ParseAction>(stateIndices.at(shiftDecision->state.get())) + 1;
+            } else {
+                SHOULD_NOT_HAPPEN;
+            }
         }
     }
-
-    return res;
+    parseTables = ParseTables(actionTable, gotoTable);
 }
 
-SymbolsSet SyntaxAnalyzer::first(Symbol symbol)
+void SyntaxAnalyzer::computeFirstFollow()
 {
-    if (isTerminal(symbol)) {
-        return {symbol};
+    firstSets.assign(nonTerminalsCount, {});
+    nullableSymbols.reset();
+    for (bool wasChanged = true; wasChanged;) {
+        wasChanged = false;
+        for (const auto &rule : rules) {
+            const auto lhs = static_cast<size_t>(rule.lhs);
+            TerminalsSet ruleFirst;
+            const bool isRuleNullable = addFirst(rule.rhs, 0, ruleFirst);
+            if ((firstSets[lhs] | ruleFirst) != firstSets[lhs]) {
+                firstSets[lhs] |= ruleFirst;
+                wasChanged = true;
+            }
+            if (isRuleNullable && !nullableSymbols[lhs]) {
+                nullableSymbols[lhs] = true;
+                wasChanged = true;
+            }
+        }
     }
 
-    if (auto symbolsIt = mFirstCache.find(symbol); symbolsIt != mFirstCache.end()) {
-        return symbolsIt->second;
+    followSets.assign(nonTerminalsCount, {});
+    followSets[static_cast<size_t>(startSymbol)][static_cast<size_t>(
+        std::get<TerminalSymbol>(endSymbol))] = true;
+    for (bool wasChanged = true; wasChanged;) {
+        wasChanged = false;
+        for (const auto &rule : rules) {
+            // the terminals which can follow the current symbol of the rule
+            TerminalsSet trailer = followSets[static_cast<size_t>(rule.lhs)];
+            for (auto it = rule.rhs.rbegin(); it != rule.rhs.rend(); ++it) {
+                if (isTerminal(*it)) {
+                    trailer.reset();
+                    trailer[static_cast<size_t>(std::get<TerminalSymbol>(*it))] = true;
+                    continue;
+                }
+                const auto symbol = static_cast<size_t>(std::get<NonTerminalSymbol>(*it));
+                if ((followSets[symbol] | trailer) != followSets[symbol]) {
+                    followSets[symbol] |= trailer;
+                    wasChanged = true;
+                }
+                if (nullableSymbols[symbol]) {
+                    trailer |= firstSets[symbol];
+                } else {
+                    trailer = firstSets[symbol];
+                }
+            }
+        }
     }
+}
 
-    mFirstCache[symbol] = {}; // to prevent infinite recursion
-
-    SymbolsSet res;
-
-    for (const auto &rule : allRulesSet) {
-        if (Symbol(rule.lhs) != symbol) {
-            continue;
+bool SyntaxAnalyzer::addFirst(const Symbols &symbols, size_t begin, TerminalsSet &res) const
+{
+    for (size_t i = begin; i < symbols.size(); ++i) {
+        if (isTerminal(symbols[i])) {
+            res[static_cast<size_t>(std::get<TerminalSymbol>(symbols[i]))] = true;
+            return false;
         }
-        for (auto rhsSymbol : rule.rhs) {
-            auto currSymbolFirstSet = first(rhsSymbol);
-            res.merge(currSymbolFirstSet);
-            if (currSymbolFirstSet.find(EPS) == currSymbolFirstSet.end()) {
-                break;
-            }
+        const auto symbol = static_cast<size_t>(std::get<NonTerminalSymbol>(symbols[i]));
+        res |= firstSets[symbol];
+        if (!nullableSymbols[symbol]) {
+            return false;
         }
     }
+    return true;
+}
 
-    mFirstCache[symbol] = res;
+const SyntaxAnalyzer::TerminalsSet &SyntaxAnalyzer::getFirst(NonTerminalSymbol symbol) const
+{
+    return firstSets.at(static_cast<size_t>(symbol));
+}
 
-    return res;
+const SyntaxAnalyzer::TerminalsSet &SyntaxAnalyzer::getFollow(NonTerminalSymbol symbol) const
+{
+    return followSets.at(static_cast<size_t>(symbol));
 }
 
-SymbolsSet SyntaxAnalyzer::follow(Symbol symbol)
+bool SyntaxAnalyzer::isNullable(NonTerminalSymbol symbol) const
 {
-    if (auto symbolsIt = mFollowCache.find(symbol); symbolsIt != mFollowCache.end()) {
-        return symbolsIt->second;
-    }
+    return nullableSymbols[static_cast<size_t>(symbol)];
+}
 
-    mFollowCache[symbol] = {}; // to prevent infinite recursion
-    SymbolsSet res;
+Symbol SyntaxAnalyzer::getCurrSymbol(Item item) const
+{
+    const auto &rhs = rules[item.getRuleIndex()].rhs;
+    return item.getPos() < rhs.size() ? rhs[item.getPos()] : EPS;
+}
 
-    if (symbol == Symbol(startSymbol)) {
-        res = {endSymbol};
-    } else {
-        for (const auto &rule : allRulesSet) {
-            for (size_t i = 0; i < rule.rhs.size(); ++i) {
-                if (rule.rhs[i] != symbol) {
-                    continue;
-                }
+void SyntaxAnalyzer::addItemLookaheads(Item item, TerminalsSet &res) const
+{
+    // LR(0) items don't pass any lookaheads on
+    if (item.hasLookahead() &&
+        addFirst(rules[item.getRuleIndex()].rhs, item.getPos() + 1, res)) {
+        res[item.getLookahead()] = true;
+    }
+}
 
-                if (i == rule.rhs.size() - 1) {
-                    res.merge(follow(rule.lhs));
-                } else {
-                    auto currFirst = first(rule.rhs[i + 1]);
-                    res.merge(currFirst);
-                    if (currFirst.find(EPS) != currFirst.end()) {
-                        res.merge(follow(rule.lhs));
-                    } else {
-                        break;
-                    }
-                }
-            }
+static void normalizeItemsSet(ItemsSet &itemsSet)
+{
+    std::sort(itemsSet.begin(), itemsSet.end());
+    itemsSet.erase(std::unique(itemsSet.begin(), itemsSet.end()), itemsSet.end());
+}
+
+ItemsSet SyntaxAnalyzer::closure(const ItemsSet &itemsSet)
+{
+    // the closure with a lookaheads set is the union of the closures with every lookahead of it,
+    // so the items with the same current nonterminal are closed at once
+    std::map<NonTerminalSymbol, TerminalsSet> lookaheadsByNonTerminal;
+    for (const auto item : itemsSet) {
+        const auto itemCurrSymbol = getCurrSymbol(item);
+        if (itemCurrSymbol == EPS || isTerminal(itemCurrSymbol)) {
+            continue;
         }
+        addItemLookaheads(item,
+                          lookaheadsByNonTerminal[std::get<NonTerminalSymbol>(itemCurrSymbol)]);
     }
 
-    res.erase(EPS);
-    mFollowCache[symbol] = res;
-    return res;
+    ItemsSet resSet = itemsSet;
+    for (const auto &[nonTerminal, lookaheads] : lookaheadsByNonTerminal) {
+        const auto &nonTerminalClosure = closeNonTerminal(nonTerminal, lookaheads);
+        resSet.insert(resSet.end(), nonTerminalClosure.begin(), nonTerminalClosure.end());
+    }
+    normalizeItemsSet(resSet);
+
+    return resSet;
 }
 
-ItemsSet SyntaxAnalyzer::closure(const ItemsSet &itemsSet)
+const ItemsSet &SyntaxAnalyzer::closeNonTerminal(NonTerminalSymbol nonTerminal,
+                                                 const TerminalsSet &lookaheads)
 {
+    // the references to the elements stay valid when other closures are added
+    auto &closures = closuresCache[static_cast<size_t>(nonTerminal)];
+    {
+        const std::lock_guard lock(closuresCacheMutex);
+        if (const auto it = closures.find(lookaheads); it != closures.end()) {
+            return it->second;
+        }
+    }
+
+    // all the items of the closure are at the beginnings of their rules, so they are marked by
+    // their rules and lookaheads
+    const size_t lookaheadsCount = Item::noLookahead + 1;
+    std::vector<bool> isAdded(rules.size() * lookaheadsCount, false);
     ItemsSet resSet;
     std::stack<Item> toCheck;
-    for (const auto &item : itemsSet) {
-        toCheck.push(item);
-    }
+    auto addRulesItems = [&](NonTerminalSymbol lhs, const TerminalsSet &rulesLookaheads) {
+        for (const auto ruleIndex : rulesByLhs[static_cast<size_t>(lhs)]) {
+            auto addItem = [&](uint32_t lookahead) {
+                if (isAdded[ruleIndex * lookaheadsCount + lookahead]) {
+                    return;
+                }
+                isAdded[ruleIndex * lookaheadsCount + lookahead] = true;
+                resSet.push_back(Item(ruleIndex, 0, lookahead));
+                toCheck.push(resSet.back());
+            };
+            if (construction == LrConstruction::LALR1) {
+                addItem(Item::noLookahead);
+                continue;
+            }
+            for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+                if (rulesLookaheads[terminal]) {
+                    addItem(static_cast<uint32_t>(terminal));
+                }
+            }
+        }
+    };
 
+    addRulesItems(nonTerminal, lookaheads);
     while (!toCheck.empty()) {
         const auto item = toCheck.top();
         toCheck.pop();
-        if (item.pos == item.rhs.size()) {
+        const auto itemCurrSymbol = getCurrSymbol(item);
+        if (itemCurrSymbol == EPS || isTerminal(itemCurrSymbol)) {
             continue;
         }
-        ASSERT(item.pos < item.rhs.size());
-        const auto &itemCurrSymbol = item.rhs[item.pos];
-
-        Symbols itemTail;
-        itemTail.insert(itemTail.end(), std::next(item.rhs.begin(), item.pos + 1), item.rhs.end());
-        itemTail.push_back(item.lookaheadSymbol);
-        const auto lookaheadSymbols = first(itemTail);
+        TerminalsSet itemLookaheads;
+        addItemLookaheads(item, itemLookaheads);
+        addRulesItems(std::get<NonTerminalSymbol>(itemCurrSymbol), itemLookaheads);
+    }
+    normalizeItemsSet(resSet);
 
-        for (const auto &rule : allRulesSet) {
-            if (Symbol(rule.lhs) != itemCurrSymbol) {
-                continue;
-            }
+    // another thread could add the same closure meanwhile, then it is kept
+    const std::lock_guard lock(closuresCacheMutex);
+    return closures.emplace(lookaheads, std::move(resSet)).first->second;
+}
 
-            for (const auto &lookaheadSymbol : lookaheadSymbols) {
-                const auto newItem = Item(rule, 0, lookaheadSymbol);
-                const bool wasInserted = resSet.insert(newItem).second;
-                if (wasInserted) {
-                    toCheck.push(newItem);
-                }
-            }
+ItemsSet SyntaxAnalyzer::gotoKernel(const ItemsSet &itemsSet, Symbol symbol) const
+{
+    // moving the positions keeps the items sorted
+    ItemsSet resSet;
+    for (const auto item : itemsSet) {
+        if (getCurrSymbol(item) == symbol) {
+            resSet.push_back(item.advance());
         }
     }
-    for (const auto &item : itemsSet) {
-        resSet.insert(item);
-    }
 
     return resSet;
 }
 
-ItemsSet SyntaxAnalyzer::gotoItems(const ItemsSet &itemsSet, Symbol symbol)
+static void reportConflict(const Decision &existingDecision, const Decision &decision,
+                           Symbol lookaheadSym)
 {
-    ItemsSet resSet;
+    LOG_FATAL << "Conflict: can't add decision with type = " << variantTypeToString(decision)
+              << ", because decision with type = " << variantTypeToString(existingDecision)
+              << "; lookaheadSymbol = " << getSymbolName(lookaheadSym);
+}
 
-    for (const auto &item : itemsSet) {
-        if (item.pos != item.rhs.size()) {
-            const auto itemCurrSymbol = item.rhs[item.pos];
-            if (itemCurrSymbol == symbol) {
-                resSet.insert(Item(item, item.pos + 1));
-            }
+static size_t hashItemsSet(const ItemsSet &itemsSet)
+{
+    // the items are sorted, so the same sets give the same hash
+    size_t res = itemsSet.size();
+    auto combine = [&res](size_t value) { res ^= value + 0x9e3779b9 + (res << 6) + (res >> 2); };
+    for (const auto item : itemsSet) {
+        combine(std::hash<uint64_t>{}(item.getPacked()));
+    }
+    return res;
+}
+
+std::pair<State::SharedPtr, bool> SyntaxAnalyzer::findOrAddState(ItemsSet kernelItems)
+{
+    const size_t hash = hashItemsSet(kernelItems);
+    const auto [sameHashBegin, sameHashEnd] = statesByHash.equal_range(hash);
+    for (auto it = sameHashBegin; it != sameHashEnd; ++it) {
+        if (it->second->kernelItems == kernelItems) {
+            return {it->second, false};
         }
     }
 
-    return closure(resSet);
+    auto state = std::make_shared<State>(std::move(kernelItems));
+    allStates.emplace_back(state);
+    statesByHash.emplace(hash, state);
+    return {state, true};
 }
 
-static void reportConflict(const Decision &decision, Symbol lookaheadSym)
+SyntaxAnalyzer::StateTransitions SyntaxAnalyzer::computeTransitions(const State &state)
 {
-    LOG_FATAL << "Conflict: can't add decision with type = " << variantTypeToString(decision)
-              << ", because decision with type = " << variantTypeToString(decision)
-              << "; lookaheadSymbol = " << getSymbolName(lookaheadSym);
+    const ItemsSet itemsSet = closure(state.kernelItems);
+    StateTransitions transitions;
+    // the lookaheads of LR(0) items aren't known yet
+    for (const auto item : itemsSet) {
+        if (getCurrSymbol(item) == EPS && item.hasLookahead()) {
+            transitions.reductions.emplace_back(static_cast<TerminalSymbol>(item.getLookahead()),
+                                                item.getRuleIndex());
+        }
+    }
+    for (const auto symbol : allSymbols) {
+        if (ItemsSet destKernelItems = gotoKernel(itemsSet, symbol); !destKernelItems.empty()) {
+            transitions.gotoKernels.emplace_back(symbol, std::move(destKernelItems));
+        }
+    }
+    return transitions;
 }
 
-void SyntaxAnalyzer::fillStateTables(const State::SharedPtr state)
+void SyntaxAnalyzer::fillStateTables(const State::SharedPtr state, StateTransitions transitions,
+                                     std::vector<State::SharedPtr> &newStates)
 {
     // add reductions
-    for (auto &item : state->itemsSet) {
-        if (item.pos == item.rhs.size()) {
-            if (const auto &existingDecision = state->getDecision(item.lookaheadSymbol)) {
-                reportConflict(*existingDecision, item.lookaheadSymbol);
-            }
-
-            state->addDecision(item.lookaheadSymbol, ReduceDecision{item.lhs, item.rhs});
+    for (const auto &[lookahead, ruleIndex] : transitions.reductions) {
+        const ReduceDecision reduceDecision{ruleIndex};
+        const Symbol lookaheadSymbol = lookahead;
+        if (const auto &existingDecision = state->getDecision(lookaheadSymbol)) {
+            reportConflict(*existingDecision, reduceDecision, lookaheadSymbol);
         }
+
+        state->addDecision(lookaheadSymbol, reduceDecision);
     }
 
     // add shifts
-    for (auto symbol : allSymbols) {
-        ItemsSet destStateItems = gotoItems(state->itemsSet, symbol);
-        if (destStateItems.empty()) {
-            continue;
-        }
+    for (auto &[symbol, destKernelItems] : transitions.gotoKernels) {
         if (const auto &existingDecision = state->getDecision(symbol)) {
-            reportConflict(*existingDecision, symbol);
+            reportConflict(*existingDecision, ShiftDecision{nullptr}, symbol);
         }
-        auto destState = std::make_shared<State>(destStateItems);
         /*
          * Consider the case with left recursion:
          * E->EA; E->A;
@@ -334,22 +635,185 @@ void SyntaxAnalyzer::fillStateTables(const State::SharedPtr state)
          *
          * While the example may not be 100% accurate, it proves that the algorithm will create
          * infinite number of states, so let's check whether we already have the same state in the
-         * analyzer. This can be optimized, but it works ok for now.
+         * analyzer. The states are looked up by the hash of their kernels.
          */
-        auto existingStateIt =
-            std::find_if(allStates.begin(), allStates.end(), [&destState](const auto &toCmp) {
-                return toCmp->itemsSet == destState->itemsSet;
-            });
-        const bool doesStateExist = existingStateIt != allStates.end();
-        if (doesStateExist) {
-            destState = *existingStateIt;
-        }
+        const auto [destState, isNewState] = findOrAddState(std::move(destKernelItems));
 
         state->addDecision(symbol, ShiftDecision{destState});
         state->addGotoState(symbol, destState);
-        if (!doesStateExist) {
-            allStates.emplace_back(destState);
-            fillStateTables(destState);
+        if (isNewState) {
+            newStates.push_back(destState);
+        }
+    }
+}
+
+/*
+ * DeRemer and Pennello's digraph algorithm: every set becomes the union of the initial sets of all
+ * the vertices reachable from its vertex by the relation. A strongly connected component shares a
+ * single set, so each edge is followed once. The traversal keeps its own stack of calls.
+ */
+static void digraph(const std::vector<std::vector<size_t>> &relation,
+                    std::vector<SyntaxAnalyzer::TerminalsSet> &sets)
+{
+    constexpr size_t doneLowLink = SIZE_MAX;
+    struct Call
+    {
+        size_t vertex;
+        size_t nextEdge;
+    };
+
+    // depth 0 marks a vertex which wasn't visited yet
+    std::vector<size_t> depths(relation.size(), 0), lowLinks(relation.size(), 0);
+    std::vector<size_t> visited;
+    std::vector<Call> calls;
+    auto enter = [&](size_t vertex) {
+        visited.push_back(vertex);
+        depths[vertex] = lowLinks[vertex] = visited.size();
+        calls.push_back({vertex, 0});
+    };
+    auto takeFrom = [&](size_t vertex, size_t next) {
+        lowLinks[vertex] = std::min(lowLinks[vertex], lowLinks[next]);
+        sets[vertex] |= sets[next];
+    };
+
+    for (size_t root = 0; root < relation.size(); ++root) {
+        if (depths[root] != 0) {
+            continue;
+        }
+        enter(root);
+        while (!calls.empty()) {
+            const size_t vertex = calls.back().vertex;
+            if (calls.back().nextEdge < relation[vertex].size()) {
+                const size_t next = relation[vertex][calls.back().nextEdge++];
+                if (depths[next] == 0) {
+                    enter(next);
+                } else {
+                    takeFrom(vertex, next);
+                }
+                continue;
+            }
+
+            if (lowLinks[vertex] == depths[vertex]) {
+                size_t member;
+                do {
+                    member = visited.back();
+                    visited.pop_back();
+                    lowLinks[member] = doneLowLink;
+                    if (member != vertex) {
+                        sets[member] = sets[vertex];
+                    }
+                } while (member != vertex);
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                takeFrom(calls.back().vertex, vertex);
+            }
+        }
+    }
+}
+
+void SyntaxAnalyzer::addLalrReductions()
+{
+    std::unordered_map<const State *, size_t> stateIndices;
+    for (size_t i = 0; i < allStates.size(); ++i) {
+        stateIndices[allStates[i].get()] = i;
+    }
+    auto getGotoIndex = [&](size_t stateIndex, Symbol symbol) {
+        const auto gotoState = allStates[stateIndex]->getGotoState(symbol);
+        ASSERT(gotoState);
+        return stateIndices.at(gotoState.get());
+    };
+
+    auto areNullable = [this](auto begin, auto end) {
+        return std::all_of(begin, end, [this](Symbol symbol) {
+            return !isTerminal(symbol) && isNullable(std::get<NonTerminalSymbol>(symbol));
+        });
+    };
+
+    // the transitions by nonterminals, the first one is a virtual transition from the start state
+    // by the start symbol, which is followed by the end symbol
+    std::vector<std::pair<size_t, NonTerminalSymbol>> transitions = {{0, startSymbol}};
+    std::map<std::pair<size_t, Symbol>, size_t> transitionIndices;
+    // the terminals which can be shifted right after a transition, then the lookaheads
+    std::vector<TerminalsSet> follows(1);
+    follows[0][static_cast<size_t>(std::get<TerminalSymbol>(endSymbol))] = true;
+    for (size_t stateIndex = 0; stateIndex < allStates.size(); ++stateIndex) {
+        for (const auto symbol : allSymbols) {
+            const auto gotoState = allStates[stateIndex]->getGotoState(symbol);
+            if (isTerminal(symbol) || !gotoState) {
+                continue;
+            }
+            transitionIndices[{stateIndex, symbol}] = transitions.size();
+            transitions.emplace_back(stateIndex, std::get<NonTerminalSymbol>(symbol));
+            TerminalsSet &directReads = follows.emplace_back();
+            for (const auto nextSymbol : allSymbols) {
+                if (isTerminal(nextSymbol) && gotoState->getGotoState(nextSymbol)) {
+                    directReads[static_cast<size_t>(std::get<TerminalSymbol>(nextSymbol))] = true;
+                }
+            }
+        }
+    }
+
+    // (p, A) reads (r, C) if p goes to r by A and C is nullable
+    std::vector<std::vector<size_t>> reads(transitions.size());
+    for (size_t i = 1; i < transitions.size(); ++i) {
+        const size_t gotoIndex = getGotoIndex(transitions[i].first, transitions[i].second);
+        for (size_t symbol = 0; symbol < nonTerminalsCount; ++symbol) {
+            if (!nullableSymbols[symbol]) {
+                continue;
+            }
+            const Symbol nonTerminal = static_cast<NonTerminalSymbol>(symbol);
+            if (const auto it = transitionIndices.find({gotoIndex, nonTerminal});
+                it != transitionIndices.end()) {
+                reads[i].push_back(it->second);
+            }
+        }
+    }
+    digraph(reads, follows);
+
+    // (p, A) includes (p', B) if B -> xAy, y is nullable and p' goes to p by x,
+    // the reduction by B -> x in q looks back at (p', B) if p' goes to q by x
+    std::vector<std::vector<size_t>> includes(transitions.size());
+    std::map<std::pair<size_t, size_t>, std::vector<size_t>> lookbacks;
+    for (size_t i = 0; i < transitions.size(); ++i) {
+        const auto [fromIndex, lhs] = transitions[i];
+        for (const auto ruleIndex : rulesByLhs[static_cast<size_t>(lhs)]) {
+            const auto &rule = rules[ruleIndex];
+            size_t stateIndex = fromIndex;
+            for (size_t pos = 0; pos < rule.rhs.size(); ++pos) {
+                if (isNonTermional(rule.rhs[pos]) &&
+                    areNullable(std::next(rule.rhs.begin(), pos + 1), rule.rhs.end())) {
+                    includes[transitionIndices.at({stateIndex, rule.rhs[pos]})].push_back(i);
+                }
+                stateIndex = getGotoIndex(stateIndex, rule.rhs[pos]);
+            }
+            lookbacks[{stateIndex, ruleIndex}].push_back(i);
+        }
+    }
+    digraph(includes, follows);
+
+    for (size_t stateIndex = 0; stateIndex < allStates.size(); ++stateIndex) {
+        const auto &state = allStates[stateIndex];
+        // the completed items with empty rules are outside of the kernel
+        for (const auto item : closure(state->kernelItems)) {
+            if (getCurrSymbol(item) != EPS) {
+                continue;
+            }
+            const ReduceDecision reduceDecision{item.getRuleIndex()};
+            TerminalsSet lookaheadSymbols;
+            for (const auto transition : lookbacks[{stateIndex, item.getRuleIndex()}]) {
+                lookaheadSymbols |= follows[transition];
+            }
+            for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+                if (!lookaheadSymbols[terminal]) {
+                    continue;
+                }
+                const Symbol lookaheadSymbol = static_cast<TerminalSymbol>(terminal);
+                if (const auto &existingDecision = state->getDecision(lookaheadSymbol)) {
+                    reportConflict(*existingDecision, reduceDecision, lookaheadSymbol);
+                }
+                state->addDecision(lookaheadSymbol, reduceDecision);
+            }
         }
     }
 }
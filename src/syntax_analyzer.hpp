@@ -1,11 +1,25 @@
 #ifndef SYNTAX_ANALYZER_HPP
 #define SYNTAX_ANALYZER_HPP
 
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <stack>
 #include <unordered_map>
 #include <variant>
 
+#include "log.hpp"
+#include "parse_tables.hpp"
 #include "symbols.hpp"
+#include "token_buffer.hpp"
+
+#include <functional>
+
+class TokenStream;
 
 struct Rule
 {
@@ -18,20 +32,62 @@ public:
 
 using RulesSet = std::set<Rule>;
 
-class Item : public Rule
+/*
+ * An item packed into an integer: the index of its rule in the rules of the analyzer, the position
+ * in the rule and the lookahead terminal. The items are ordered by the rule, then by the position
+ * and then by the lookahead. The items without a lookahead (LR(0) items) have noLookahead.
+ */
+class Item
 {
 public:
-    Item(Rule rule, size_t tPos, Symbol tLookaheadSymbol);
-    Item(Item item, size_t tPos);
+    static constexpr uint32_t noLookahead = magic_enum::enum_count<TerminalSymbol>();
+
+    Item(size_t ruleIndex, size_t pos, uint32_t lookahead)
+        : packed(static_cast<uint64_t>(ruleIndex) << 32 | static_cast<uint64_t>(pos) << 16 |
+                 lookahead)
+    {
+        ASSERT(ruleIndex <= UINT32_MAX && pos <= UINT16_MAX && lookahead <= noLookahead);
+    }
 
     auto operator<=>(const Item &) const = default;
 
-    const size_t pos;
-    const Symbol lookaheadSymbol;
+    size_t getRuleIndex() const
+    {
+        return packed >> 32;
+    }
+
+    size_t getPos() const
+    {
+        return (packed >> 16) & UINT16_MAX;
+    }
+
+    uint32_t getLookahead() const
+    {
+        return packed & UINT16_MAX;
+    }
+
+    bool hasLookahead() const
+    {
+        return getLookahead() != noLookahead;
+    }
+
+    // the item with the position moved past the current symbol
+    Item advance() const
+    {
+        return Item(getRuleIndex(), getPos() + 1, getLookahead());
+    }
+
+    uint64_t getPacked() const
+    {
+        return packed;
+    }
+
+private:
+    uint64_t packed;
 };
 
-using Items = std::vector<Item>;
-using ItemsSet = std::set<Item>;
+// sorted and without duplicates, so the same sets are equal vectors
+using ItemsSet = std::vector<Item>;
 
 struct ReduceDecision;
 struct ShiftDecision;
@@ -42,14 +98,18 @@ class State
 public:
     using SharedPtr = std::shared_ptr<State>;
 
-    State(ItemsSet tItemsSet);
+    State(ItemsSet tKernelItems);
     std::optional<Decision> getDecision(Symbol lookaheadSymbol);
     void addDecision(Symbol lookaheadSymbol, Decision decision);
 
     SharedPtr getGotoState(Symbol lookaheadSymbol);
     void addGotoState(Symbol lookaheadSymbol, SharedPtr state);
+    // the states refer to each other, so they have to be released explicitly
+    void release();
 
-    ItemsSet itemsSet;
+    // the closure of the kernel gives the other items of the state, the states with the same
+    // kernels are the same
+    ItemsSet kernelItems;
 
 private:
     std::unordered_map<Symbol, Decision> decisionTable;
@@ -58,8 +118,7 @@ private:
 
 struct ReduceDecision
 {
-    NonTerminalSymbol lhs;
-    Symbols rhs;
+    size_t ruleIndex;
 };
 
 struct ShiftDecision
@@ -74,36 +133,124 @@ std::optional<T> tryConvertDecision(const Decision &decision)
     return ret ? std::make_optional(*ret) : std::nullopt;
 }
 
+enum class LrConstruction
+{
+    // a state per set of LR(1) items, states with the same items but different lookaheads aren't
+    // merged
+    CANONICAL_LR1,
+    // the states of the LR(0) automaton with the lookaheads computed by DeRemer-Pennello
+    // propagation, much fewer states but reduce/reduce conflicts are possible for some grammars
+    LALR1
+};
+
 class SyntaxAnalyzer
 {
 public:
-    SyntaxAnalyzer(NonTerminalSymbol tStartSymbol, TerminalSymbol tEndSymbol);
+    // views into tables that were built before, usually generated by writeTables
+    struct Tables
+    {
+        NonTerminalSymbol startSymbol;
+        TerminalSymbol endSymbol;
+        std::span<const ParseRule> rules;
+        ParseTables::Packed parseTables;
+    };
+
+    SyntaxAnalyzer(NonTerminalSymbol tStartSymbol, TerminalSymbol tEndSymbol,
+                   LrConstruction tConstruction = LrConstruction::CANONICAL_LR1);
+    // the parser runs on the tables, the rules can't be added to it
+    explicit SyntaxAnalyzer(const Tables &tables);
 
     void addRule(NonTerminalSymbol lhs, Symbols rhsSymbols);
     void addRules(NonTerminalSymbol lhs, std::vector<Symbols> rhses);
 
-    void start();
+    // the transitions of the states are computed by threadsCount threads, 0 means a thread per
+    // core, the tables are the same for any threads count
+    void start(size_t threadsCount = 1);
+    size_t getStatesCount() const;
+    const ParseTables &getParseTables() const;
+    // writes a C++ definition of "const SyntaxAnalyzer::Tables <name>", start has to be called
+    // before
+    void writeTables(std::ostream &stream, std::string_view name) const;
     NonTerminalSymbolSt::SharedPtr parse(TerminalSymbolsSt symbols);
+    NonTerminalSymbolSt::SharedPtr parse(const TokenBuffer &tokens);
+    // the end symbol is added after the last token of the stream
+    NonTerminalSymbolSt::SharedPtr parse(TokenStream &tokens);
+
+    static constexpr size_t terminalsCount = ParseTables::terminalsCount;
+    static constexpr size_t nonTerminalsCount = ParseTables::nonTerminalsCount;
+    // a set of terminals indexed by their values
+    using TerminalsSet = std::bitset<terminalsCount>;
+
+    // the sets are computed by start, the parser loaded from tables doesn't have them
+    const TerminalsSet &getFirst(NonTerminalSymbol symbol) const;
+    const TerminalsSet &getFollow(NonTerminalSymbol symbol) const;
+    bool isNullable(NonTerminalSymbol symbol) const;
 
 private:
-    SymbolsSet first(Symbol symbol);
-    SymbolsSet first(Symbols symbols);
-    SymbolsSet follow(Symbol symbol);
+    // the tokens are pulled one by one, the last one has to be the end symbol
+    NonTerminalSymbolSt::SharedPtr parseTokens(const std::function<Token()> &getNextToken);
+    // flattens the decisions of the states into dense tables and packs them for the parser
+    void buildParseTables();
+
+    // computes FIRST, FOLLOW and nullable of all the nonterminals by fixpoint iterations
+    void computeFirstFollow();
+    // adds FIRST of the symbols starting at begin to res, returns whether all of them are nullable
+    bool addFirst(const Symbols &symbols, size_t begin, TerminalsSet &res) const;
+    // returns the symbol after the position of the item, EPS if the item is completed
+    Symbol getCurrSymbol(Item item) const;
+    // adds the lookaheads of the items derived from the current symbol of the item
+    void addItemLookaheads(Item item, TerminalsSet &res) const;
     ItemsSet closure(const ItemsSet &items);
-    ItemsSet gotoItems(const ItemsSet &itemSet, Symbol symbol);
+    // the closure of the nonterminal rules with the lookaheads, it is cached for every lookaheads
+    // set, the LALR(1) construction closes LR(0) items with the empty set
+    const ItemsSet &closeNonTerminal(NonTerminalSymbol nonTerminal, const TerminalsSet &lookaheads);
+    // the kernel of the state which the items go to by the symbol
+    ItemsSet gotoKernel(const ItemsSet &itemsSet, Symbol symbol) const;
 
-    void fillStateTables(const State::SharedPtr state);
+    // what the items of a state go to, it doesn't change the states, so the transitions of several
+    // states are computed in parallel
+    struct StateTransitions
+    {
+        // the completed items by their lookaheads
+        std::vector<std::pair<TerminalSymbol, size_t>> reductions;
+        std::vector<std::pair<Symbol, ItemsSet>> gotoKernels;
+    };
+    // the closure of the state exists only while its transitions are computed
+    StateTransitions computeTransitions(const State &state);
+    // the states which weren't created before are added to newStates
+    void fillStateTables(const State::SharedPtr state, StateTransitions transitions,
+                         std::vector<State::SharedPtr> &newStates);
+    // adds the reductions to the LR(0) states with the lookaheads computed for LALR(1)
+    void addLalrReductions();
+    // returns the existing state with the same items and a new one if there is no such state
+    std::pair<State::SharedPtr, bool> findOrAddState(ItemsSet kernelItems);
 
     RulesSet allRulesSet;
-    ItemsSet allItemsSet;
-    State::SharedPtr startState;
+    // the rules of allRulesSet in its order, the items and the parse tables refer to their indices
+    std::vector<Rule> rules;
+    // the indices of the rules by the values of their left-hand sides
+    std::array<std::vector<size_t>, nonTerminalsCount> rulesByLhs;
+    // the states are kept only while the tables are built
     std::vector<State::SharedPtr> allStates;
+    // the states by the hashes of their kernels, the kernels are compared only on a hash collision
+    std::unordered_multimap<size_t, State::SharedPtr> statesByHash;
 
     NonTerminalSymbol startSymbol;
     Symbol endSymbol;
+    LrConstruction construction;
+    bool isLoadedFromTables = false;
     std::set<Symbol> allSymbols;
 
-    std::unordered_map<Symbol, SymbolsSet> mFollowCache, mFirstCache;
+    // indexed by the values of nonterminals
+    std::vector<TerminalsSet> firstSets, followSets;
+    std::bitset<nonTerminalsCount> nullableSymbols;
+    // the closures are kept only while the states are built
+    std::array<std::unordered_map<TerminalsSet, ItemsSet>, nonTerminalsCount> closuresCache;
+    std::mutex closuresCacheMutex;
+
+    // the states are numbered in the order of allStates, the start state is 0
+    std::vector<ParseRule> parseRules;
+    ParseTables parseTables;
 
     const Symbol EPS = Symbol(NonTerminalSymbol::EPS);
 };
@@ -0,0 +1,70 @@
+#ifndef TOKEN_BUFFER_HPP
+#define TOKEN_BUFFER_HPP
+
+#include "log.hpp"
+#include "symbols.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct Token
+{
+    TerminalSymbol symbolType;
+    std::string_view text;
+};
+
+/*
+ * Stores tokens column-wise: types, offsets and lengths are kept in separate arrays and the text of
+ * a token is a view into the source, so adding a token doesn't allocate anything on its own.
+ * The source has to outlive the buffer.
+ */
+class TokenBuffer
+{
+public:
+    TokenBuffer(std::string_view source_) : source(source_)
+    {
+        ASSERT(source.size() <= UINT32_MAX);
+    }
+
+    void push(TerminalSymbol symbolType, size_t offset, size_t length)
+    {
+        ASSERT(offset + length <= source.size());
+        symbolTypes.push_back(symbolType);
+        offsets.push_back(static_cast<uint32_t>(offset));
+        lengths.push_back(static_cast<uint32_t>(length));
+    }
+
+    size_t size() const
+    {
+        return symbolTypes.size();
+    }
+
+    TerminalSymbol getSymbolType(size_t index) const
+    {
+        return symbolTypes[index];
+    }
+
+    size_t getOffset(size_t index) const
+    {
+        return offsets[index];
+    }
+
+    std::string_view getText(size_t index) const
+    {
+        return source.substr(offsets[index], lengths[index]);
+    }
+
+    Token operator[](size_t index) const
+    {
+        return {getSymbolType(index), getText(index)};
+    }
+
+private:
+    std::string_view source;
+    std::vector<TerminalSymbol> symbolTypes;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+};
+
+#endif // TOKEN_BUFFER_HPP
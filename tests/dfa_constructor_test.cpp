@@ -0,0 +1,244 @@
+#include "lexical_analyzer/dfa_constructor.hpp"
+#include "lexical_analyzer/scheme_rules.hpp"
+#include <cctype>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// ===== Minimization =====
+
+TEST(Minimization, SingleCharLoop)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("[abc]+", TerminalSymbol::ID);
+    // dead, start and the accepting loop
+    EXPECT_EQ(lexConstructor->getStatesCount(), 3);
+    // [abc] and everything else
+    EXPECT_EQ(lexConstructor->getClassesCount(), 2);
+}
+
+TEST(Minimization, EquivalentBranchesAreMerged)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("ab", TerminalSymbol::ID);
+    lexConstructor->addRule("ac", TerminalSymbol::ID);
+    // dead, start, after 'a' and accepting
+    EXPECT_EQ(lexConstructor->getStatesCount(), 4);
+    // a, [bc] and everything else
+    EXPECT_EQ(lexConstructor->getClassesCount(), 3);
+}
+
+TEST(Minimization, DifferentTokensAreNotMerged)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("ab", TerminalSymbol::ID);
+    lexConstructor->addRule("ac", TerminalSymbol::INT);
+    EXPECT_EQ(lexConstructor->getStatesCount(), 5);
+    EXPECT_EQ(lexConstructor->getClassesCount(), 4);
+
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("acab");
+    ASSERT_EQ(parseRes.size(), 2);
+    EXPECT_EQ(parseRes[0]->symbolType, TerminalSymbol::INT);
+    EXPECT_EQ(parseRes[1]->symbolType, TerminalSymbol::ID);
+}
+
+TEST(Minimization, LettersAreFoldedIntoSingleClass)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule(LexicalAnalyzerConstructor::allLetters + "+" +
+                                LexicalAnalyzerConstructor::allLettersDigits + "*",
+                            TerminalSymbol::ID);
+    lexConstructor->addRule(LexicalAnalyzerConstructor::allDigits + "+", TerminalSymbol::INT);
+    // letters, digits and everything else
+    EXPECT_EQ(lexConstructor->getClassesCount(), 3);
+    // dead, start, ID and INT
+    EXPECT_EQ(lexConstructor->getStatesCount(), 4);
+}
+
+TEST(Minimization, RebuiltAfterAddingRule)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("a", TerminalSymbol::ID);
+    EXPECT_EQ(lexConstructor->getStatesCount(), 3);
+    lexConstructor->addRule("b", TerminalSymbol::INT);
+    EXPECT_EQ(lexConstructor->getStatesCount(), 4);
+}
+
+// ===== CharClass =====
+
+// exposes the NFA the DFA is built from
+class InspectedDfaConstructor : public DfaConstructor
+{
+public:
+    size_t getTransitionsCount() const
+    {
+        return automaton.transitions.size();
+    }
+};
+
+TEST(CharClass, SingleTransitionForClass)
+{
+    InspectedDfaConstructor singleConstructor;
+    singleConstructor.addRule("[a]", TerminalSymbol::ID);
+    InspectedDfaConstructor rangesConstructor;
+    rangesConstructor.addRule("[a-zA-Z0-9]", TerminalSymbol::ID);
+    // the whole class is a single transition, just like a single char
+    EXPECT_EQ(rangesConstructor.getTransitionsCount(), singleConstructor.getTransitionsCount());
+
+    InspectedDfaConstructor groupsConstructor;
+    groupsConstructor.addRule("[a(bc)]", TerminalSymbol::ID);
+    // the union of groups is a union of transitions
+    EXPECT_GT(groupsConstructor.getTransitionsCount(), singleConstructor.getTransitionsCount());
+}
+
+TEST(CharClass, SameDfaAsSpelledOut)
+{
+    auto rangesConstructor = std::make_shared<DfaConstructor>();
+    rangesConstructor->addRule("[a-f][a-f0-9]*", TerminalSymbol::ID);
+    auto spelledConstructor = std::make_shared<DfaConstructor>();
+    spelledConstructor->addRule("[abcdef][abcdef0123456789]*", TerminalSymbol::ID);
+    auto unionConstructor = std::make_shared<DfaConstructor>();
+    unionConstructor->addRule("[abcdef][abcdef(0)(1)(2)(3)(4)(5)(6)(7)(8)(9)]*", TerminalSymbol::ID);
+    EXPECT_EQ(rangesConstructor->getStatesCount(), spelledConstructor->getStatesCount());
+    EXPECT_EQ(rangesConstructor->getClassesCount(), spelledConstructor->getClassesCount());
+    EXPECT_EQ(rangesConstructor->getStatesCount(), unionConstructor->getStatesCount());
+    EXPECT_EQ(rangesConstructor->getClassesCount(), unionConstructor->getClassesCount());
+}
+
+// ===== GeneratedTables =====
+
+TEST(GeneratedTables, SameAsBuiltFromRules)
+{
+    auto builtConstructor = std::make_shared<DfaConstructor>();
+    addSchemeRules(*builtConstructor);
+    auto loadedConstructor = makeSchemeDfaConstructor();
+    EXPECT_EQ(loadedConstructor->getStatesCount(), builtConstructor->getStatesCount());
+    EXPECT_EQ(loadedConstructor->getClassesCount(), builtConstructor->getClassesCount());
+
+    std::stringstream builtTables, loadedTables;
+    builtConstructor->writeTables(builtTables, "tables");
+    loadedConstructor->writeTables(loadedTables, "tables");
+    EXPECT_EQ(loadedTables.str(), builtTables.str());
+
+    const std::string toParse = "(define (f x) ; comment\n  (if #t \"str\" #\\a 'sym 123 <= x))";
+    const auto builtRes = LexicalAnalyzer(builtConstructor).tokenize(toParse);
+    const auto loadedRes = LexicalAnalyzer(loadedConstructor).tokenize(toParse);
+    ASSERT_EQ(loadedRes.size(), builtRes.size());
+    for (size_t i = 0; i < builtRes.size(); ++i) {
+        EXPECT_EQ(loadedRes.getSymbolType(i), builtRes.getSymbolType(i));
+        EXPECT_EQ(loadedRes.getText(i), builtRes.getText(i));
+    }
+    EXPECT_NE(builtRes.getSymbolType(builtRes.size() - 1), TerminalSymbol::ERROR);
+}
+
+// ===== SimdSkipping =====
+
+static std::vector<SimdLevel> getTestedSimdLevels()
+{
+    std::vector<SimdLevel> levels;
+    for (auto level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (level <= getSupportedSimdLevel()) {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+
+TEST(SimdSkipping, SpanByteRangesOnEveryPosition)
+{
+    ByteRanges ranges;
+    ASSERT_TRUE(ranges.assign([](uint8_t byte) { return byte == ' ' || std::isalnum(byte); }));
+    EXPECT_EQ(ranges.count, 4);
+    // the stop byte is put at every position, so it is found inside and after the vectors
+    for (size_t size = 0; size < 100; ++size) {
+        for (size_t stop = 0; stop <= size; ++stop) {
+            std::string str(size, 'a');
+            for (size_t i = 0; i < size; ++i) {
+                str[i] = "aZ0 z9"[i % 6];
+            }
+            if (stop < size) {
+                str[stop] = stop % 2 ? '\n' : '\xff';
+            }
+            for (const auto level : getTestedSimdLevels()) {
+                EXPECT_EQ(spanByteRanges(str, ranges, level), stop);
+            }
+        }
+    }
+}
+
+TEST(SimdSkipping, TooManyRanges)
+{
+    ByteRanges ranges;
+    EXPECT_FALSE(ranges.assign([](uint8_t byte) { return byte % 2 == 0; }));
+    EXPECT_EQ(ranges.count, 0);
+}
+
+TEST(SimdSkipping, SameTokensAsScalar)
+{
+    std::string toParse;
+    for (size_t i = 0; i < 50; ++i) {
+        toParse += std::string(i, ' ') + ";" + std::string(3 * i, 'c') + " (comment) \n" +
+                   std::string(i % 7, '\n') + "(define \"" + std::string(5 * i, 's') +
+                   " [str]\" " + std::string(i, 'x') + std::to_string(i * 7919) + ")";
+    }
+    // the last token is cut in the middle of a run
+    toParse += "\"" + std::string(77, 's');
+
+    auto scalarConstructor = makeSchemeDfaConstructor();
+    scalarConstructor->setSimdLevel(SimdLevel::SCALAR);
+    const auto scalarRes = LexicalAnalyzer(scalarConstructor).tokenize(toParse);
+    EXPECT_EQ(scalarRes.getSymbolType(scalarRes.size() - 1), TerminalSymbol::ERROR);
+
+    for (const auto level : getTestedSimdLevels()) {
+        auto simdConstructor = makeSchemeDfaConstructor();
+        simdConstructor->setSimdLevel(level);
+        const auto simdRes = LexicalAnalyzer(simdConstructor).tokenize(toParse);
+        ASSERT_EQ(simdRes.size(), scalarRes.size());
+        for (size_t i = 0; i < scalarRes.size(); ++i) {
+            EXPECT_EQ(simdRes.getSymbolType(i), scalarRes.getSymbolType(i));
+            EXPECT_EQ(simdRes.getText(i), scalarRes.getText(i));
+        }
+    }
+}
+
+// ===== MaximalMunch =====
+
+TEST(MaximalMunch, EveryTokenScansToTheEnd)
+{
+    // without the memo every 'a' is followed by a scan for 'b' to the end, which is quadratic
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("a", TerminalSymbol::ID);
+    lexConstructor->addRule("a*b", TerminalSymbol::INT);
+    const std::string toParse(1 << 20, 'a');
+    const auto tokens = LexicalAnalyzer(lexConstructor).tokenize(toParse);
+    ASSERT_EQ(tokens.size(), toParse.size());
+    EXPECT_EQ(tokens.getSymbolType(0), TerminalSymbol::ID);
+    EXPECT_EQ(tokens.getSymbolType(toParse.size() - 1), TerminalSymbol::ID);
+}
+
+TEST(MaximalMunch, SameTokensAsNfa)
+{
+    auto addRules = [](LexicalAnalyzerConstructor &lexConstructor) {
+        lexConstructor.addRule("a", TerminalSymbol::ID);
+        lexConstructor.addRule("a*b", TerminalSymbol::INT);
+        lexConstructor.addRule("c(ac)*d", TerminalSymbol::STRING);
+        lexConstructor.addRule("c", TerminalSymbol::BLANK);
+        lexConstructor.addRule("[ab]+e", TerminalSymbol::SYMBOL);
+    };
+    auto dfaConstructor = std::make_shared<DfaConstructor>();
+    addRules(*dfaConstructor);
+    auto nfaConstructor = std::make_shared<ThompsonConstructor>();
+    addRules(*nfaConstructor);
+    const std::string toParse = "aaabaacacacacacaccacacdaaaaaaaaaabaaaaaeaaabbbbaaaaacacac";
+
+    // the NFA simulation doesn't memoize the failures
+    const auto expected = LexicalAnalyzer(nfaConstructor).tokenize(toParse);
+    const auto tokens = LexicalAnalyzer(dfaConstructor).tokenize(toParse);
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(tokens.getSymbolType(i), expected.getSymbolType(i));
+        EXPECT_EQ(tokens.getText(i), expected.getText(i));
+    }
+}
@@ -0,0 +1,79 @@
+#include "lexical_analyzer/keyword_table.hpp"
+#include "lexical_analyzer/scheme_rules.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+static std::vector<std::pair<std::string, TerminalSymbol>> makeKeywords(size_t count)
+{
+    std::vector<std::pair<std::string, TerminalSymbol>> keywords;
+    for (size_t i = 0; i < count; ++i) {
+        keywords.push_back({"keyword" + std::to_string(i),
+                            i % 2 ? TerminalSymbol::DEFINE : TerminalSymbol::BEGIN});
+    }
+    return keywords;
+}
+
+// ===== PerfectHash =====
+
+TEST(PerfectHash, Empty)
+{
+    const KeywordTable keywordTable(std::vector<std::pair<std::string, TerminalSymbol>>{});
+    EXPECT_FALSE(keywordTable.find("define"));
+    EXPECT_FALSE(keywordTable.find(""));
+}
+
+TEST(PerfectHash, AllKeywordsAreFound)
+{
+    for (const size_t count : {1, 2, 3, 10, 100, 1000}) {
+        const auto keywords = makeKeywords(count);
+        const KeywordTable keywordTable(keywords);
+        EXPECT_LE(keywordTable.getSlotsCount(), count * 4);
+        for (const auto &[keyword, tokenToReturn] : keywords) {
+            EXPECT_EQ(keywordTable.find(keyword), tokenToReturn);
+        }
+    }
+}
+
+TEST(PerfectHash, OtherWordsAreNotFound)
+{
+    const KeywordTable keywordTable(makeKeywords(100));
+    EXPECT_FALSE(keywordTable.find(""));
+    EXPECT_FALSE(keywordTable.find("keyword"));
+    EXPECT_FALSE(keywordTable.find("keyword100"));
+    EXPECT_FALSE(keywordTable.find("keyword10a"));
+    EXPECT_FALSE(keywordTable.find("Keyword10"));
+}
+
+TEST(PerfectHash, GeneratedSchemeTable)
+{
+    const KeywordTable keywordTable(schemeKeywordTable);
+    for (const auto &[keyword, tokenToReturn] : getSchemeKeywords()) {
+        EXPECT_EQ(keywordTable.find(keyword), tokenToReturn);
+    }
+    EXPECT_FALSE(keywordTable.find("defines"));
+    EXPECT_FALSE(keywordTable.find("i"));
+}
+
+// ===== Keywords =====
+
+TEST(Keywords, ClassifiedAfterIdentifierMatch)
+{
+    auto lexConstructor = std::make_shared<DfaConstructor>();
+    lexConstructor->addRule("[abcdefghijklmnopqrstuvwxyz]+", TerminalSymbol::ID);
+    lexConstructor->addRule(" +", TerminalSymbol::BLANK);
+    const size_t statesCount = lexConstructor->getStatesCount();
+    lexConstructor->setKeywords(TerminalSymbol::ID, KeywordTable(getSchemeKeywords()));
+    // the keywords don't change the automaton
+    EXPECT_EQ(lexConstructor->getStatesCount(), statesCount);
+
+    const auto tokens = LexicalAnalyzer(lexConstructor).tokenize("define defines if i begin");
+    ASSERT_EQ(tokens.size(), 9);
+    EXPECT_EQ(tokens.getSymbolType(0), TerminalSymbol::DEFINE);
+    EXPECT_EQ(tokens.getSymbolType(2), TerminalSymbol::ID);
+    EXPECT_EQ(tokens.getSymbolType(4), TerminalSymbol::IF);
+    EXPECT_EQ(tokens.getSymbolType(6), TerminalSymbol::ID);
+    EXPECT_EQ(tokens.getSymbolType(8), TerminalSymbol::BEGIN);
+}
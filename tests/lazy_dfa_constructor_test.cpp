@@ -0,0 +1,81 @@
+#include "lexical_analyzer/lazy_dfa_constructor.hpp"
+#include "lexical_analyzer/scheme_rules.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace std;
+
+static const std::string schemeCode = "(define (f x) ; some comment\n"
+                                      "  (if (<= x 10) \"a string (with) brackets\" #\\a))\n"
+                                      "(define symbol 'sym123) (display #t) (f 1234)\n";
+
+static void expectSameTokens(const TokenBuffer &lhs, const TokenBuffer &rhs)
+{
+    ASSERT_EQ(lhs.size(), rhs.size());
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        EXPECT_EQ(lhs.getSymbolType(i), rhs.getSymbolType(i));
+        EXPECT_EQ(lhs.getText(i), rhs.getText(i));
+    }
+}
+
+// ===== Cache =====
+
+TEST(Cache, StatesAreCreatedOnDemand)
+{
+    auto lexConstructor = std::make_shared<LazyDfaConstructor>();
+    lexConstructor->addRule("abc", TerminalSymbol::ID);
+    lexConstructor->addRule("xyz", TerminalSymbol::INT);
+    LexicalAnalyzer lexicalAnalyzer(lexConstructor);
+    EXPECT_EQ(lexConstructor->getCachedStatesCount(), 0);
+
+    lexicalAnalyzer.tokenize("abc");
+    // dead, start, after 'a', after 'ab' and accepting, "xyz" wasn't reached
+    EXPECT_EQ(lexConstructor->getCachedStatesCount(), 5);
+    lexicalAnalyzer.tokenize("abcabc");
+    EXPECT_EQ(lexConstructor->getCachedStatesCount(), 5);
+    lexicalAnalyzer.tokenize("xyz");
+    EXPECT_EQ(lexConstructor->getCachedStatesCount(), 8);
+    EXPECT_EQ(lexConstructor->getFlushesCount(), 0);
+}
+
+TEST(Cache, RulesDropTheCache)
+{
+    auto lexConstructor = std::make_shared<LazyDfaConstructor>();
+    lexConstructor->addRule("a", TerminalSymbol::ID);
+    LexicalAnalyzer lexicalAnalyzer(lexConstructor);
+    lexicalAnalyzer.tokenize("a");
+    EXPECT_NE(lexConstructor->getCachedStatesCount(), 0);
+    lexConstructor->addRule("b", TerminalSymbol::INT);
+    EXPECT_EQ(lexConstructor->getCachedStatesCount(), 0);
+
+    const auto tokens = lexicalAnalyzer.tokenize("ab");
+    ASSERT_EQ(tokens.size(), 2);
+    EXPECT_EQ(tokens.getSymbolType(1), TerminalSymbol::INT);
+}
+
+TEST(Cache, SmallCacheIsFlushed)
+{
+    auto fullConstructor = std::make_shared<LazyDfaConstructor>();
+    addSchemeRules(*fullConstructor);
+    const auto expected = LexicalAnalyzer(fullConstructor).tokenize(schemeCode);
+    EXPECT_EQ(fullConstructor->getFlushesCount(), 0);
+
+    for (size_t maxCachedStates = 4; maxCachedStates < 12; ++maxCachedStates) {
+        auto lexConstructor = std::make_shared<LazyDfaConstructor>(maxCachedStates);
+        addSchemeRules(*lexConstructor);
+        const auto tokens = LexicalAnalyzer(lexConstructor).tokenize(schemeCode);
+        expectSameTokens(tokens, expected);
+        EXPECT_GT(lexConstructor->getFlushesCount(), 0);
+        EXPECT_LE(lexConstructor->getCachedStatesCount(), maxCachedStates);
+    }
+}
+
+TEST(Cache, SameTokensAsFullDfa)
+{
+    auto lexConstructor = std::make_shared<LazyDfaConstructor>();
+    addSchemeRules(*lexConstructor);
+    const auto tokens = LexicalAnalyzer(lexConstructor).tokenize(schemeCode);
+    const auto expected =
+        LexicalAnalyzer(makeSchemeDfaConstructor()).tokenize(schemeCode);
+    expectSameTokens(tokens, expected);
+}
@@ -1,14 +1,25 @@
+#include "lexical_analyzer/dfa_constructor.hpp"
+#include "lexical_analyzer/glushkov_constructor.hpp"
+#include "lexical_analyzer/lazy_dfa_constructor.hpp"
 #include "lexical_analyzer/thompson_constructor.hpp"
+#include "lexical_analyzer/token_stream.hpp"
 #include <gtest/gtest.h>
+#include <sstream>
 #include <string>
 
 using namespace std;
 
+// the same tests are built for every constructor, see tests/CMakeLists.txt
+#ifndef LEXICAL_CONSTRUCTOR
+#define LEXICAL_CONSTRUCTOR ThompsonConstructor
+#endif
+using TestedConstructor = LEXICAL_CONSTRUCTOR;
+
 // ===== Group =====
 
 TEST(Group, RuleAndParseSingleSameLetter)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("1");
     ASSERT_EQ(parseRes.size(), 1);
@@ -18,7 +29,7 @@ TEST(Group, RuleAndParseSingleSameLetter)
 
 TEST(Group, RuleAndParseStrDifferent)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1111111", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("22");
     ASSERT_EQ(parseRes.size(), 1);
@@ -28,7 +39,7 @@ TEST(Group, RuleAndParseStrDifferent)
 
 TEST(Group, RuleMatchesSeveralTimes)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     const std::string rule = "12";
     lexConstructor->addRule(rule, TerminalSymbol::ASSIGN_OP);
 
@@ -49,7 +60,7 @@ TEST(Group, RuleMatchesSeveralTimes)
 
 TEST(Group, TwoRulesFirstFails)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("222", TerminalSymbol::BLANK);
     lexConstructor->addRule("11", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("11");
@@ -60,7 +71,7 @@ TEST(Group, TwoRulesFirstFails)
 
 TEST(Group, TwoRulesMatchLongest)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("11", TerminalSymbol::BLANK);
     lexConstructor->addRule("1111", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("1111");
@@ -71,7 +82,7 @@ TEST(Group, TwoRulesMatchLongest)
 
 TEST(Group, SimpleGroup)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("(12)", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("12");
     ASSERT_EQ(parseRes.size(), 1);
@@ -81,7 +92,7 @@ TEST(Group, SimpleGroup)
 
 TEST(Group, SingleRuleNested2Times)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("((12))", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("12");
     ASSERT_EQ(parseRes.size(), 1);
@@ -91,7 +102,7 @@ TEST(Group, SingleRuleNested2Times)
 
 TEST(Group, SingleRuleNested32Times)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     std::string rule = "12";
     for (size_t i = 0; i < 32; ++i) {
         rule = '(' + rule + ')';
@@ -105,7 +116,7 @@ TEST(Group, SingleRuleNested32Times)
 
 TEST(Group, SingleRuleNested256Times)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     std::string rule = "12";
     for (size_t i = 0; i < 256; ++i) {
         rule = '(' + rule + ')';
@@ -119,7 +130,7 @@ TEST(Group, SingleRuleNested256Times)
 
 TEST(Group, GroupOf2Groups)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("((12)(34))", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("1234");
     ASSERT_EQ(parseRes.size(), 1);
@@ -129,7 +140,7 @@ TEST(Group, GroupOf2Groups)
 
 TEST(Group, TwoGroupsNested32Times)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     std::string rule = "(12)(34)";
     for (size_t i = 0; i < 32; ++i) {
         rule = '(' + rule + ')';
@@ -144,7 +155,7 @@ TEST(Group, TwoGroupsNested32Times)
 // ===== Union =====
 TEST(Union, SimpleUnion)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("[12]", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("1");
     ASSERT_EQ(parseRes.size(), 1);
@@ -154,7 +165,7 @@ TEST(Union, SimpleUnion)
 
 TEST(Union, SimpleUnionFail)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("[12]", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("3");
     ASSERT_EQ(parseRes.size(), 1);
@@ -163,7 +174,7 @@ TEST(Union, SimpleUnionFail)
 
 TEST(Union, NestedUnionsEachSymStandalone)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("[[01][2][345]]", TerminalSymbol::ASSIGN_OP);
     for (size_t i = 0; i <= 5; ++i) {
         const auto parseRes = LexicalAnalyzer(lexConstructor).parse(to_string(i));
@@ -179,7 +190,7 @@ TEST(Union, NestedUnionsEachSymStandalone)
 
 TEST(Union, NestedUnionsSymbolsTogether)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("[[01][2][345][6[7][89]]]", TerminalSymbol::ASSIGN_OP);
 
     std::string toParse;
@@ -199,7 +210,7 @@ TEST(Union, NestedUnionsSymbolsTogether)
 // ===== Asterisk =====
 TEST(Asterisk, SimpleAsterisk)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1*", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("1111");
     ASSERT_EQ(parseRes.size(), 1);
@@ -209,7 +220,7 @@ TEST(Asterisk, SimpleAsterisk)
 
 TEST(Asterisk, AsteriskMatchesEmptyAndGroup)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1*2", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("2");
     ASSERT_EQ(parseRes.size(), 1);
@@ -219,7 +230,7 @@ TEST(Asterisk, AsteriskMatchesEmptyAndGroup)
 
 TEST(Asterisk, AsteriskMatchesManyCnt)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1*", TerminalSymbol::ASSIGN_OP);
     std::string toParse;
     for (size_t i = 1; i <= 100; ++i) {
@@ -233,7 +244,7 @@ TEST(Asterisk, AsteriskMatchesManyCnt)
 
 TEST(Asterisk, AsteriskMatchesManyAndGroup)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("1*2", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("11112");
     ASSERT_EQ(parseRes.size(), 1);
@@ -243,7 +254,7 @@ TEST(Asterisk, AsteriskMatchesManyAndGroup)
 
 TEST(Asterisk, AsteriskMatchFail)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("2*", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("111111111111111");
     ASSERT_EQ(parseRes.size(), 1);
@@ -253,7 +264,7 @@ TEST(Asterisk, AsteriskMatchFail)
 
 TEST(Asterisk, AsteriskMatchAndGroupFail)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("2*3", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("111111111111111");
     ASSERT_EQ(parseRes.size(), 1);
@@ -263,7 +274,7 @@ TEST(Asterisk, AsteriskMatchAndGroupFail)
 
 TEST(Asterisk, SimpleGroupAsterisk)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     const std::string rule = "123456789";
     lexConstructor->addRule("(" + rule + ")*", TerminalSymbol::ASSIGN_OP);
 
@@ -282,7 +293,7 @@ TEST(Asterisk, SimpleGroupAsterisk)
 
 TEST(Asterisk, GroupAsteriskMatchesAndFail)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     const std::string rule = "123456789";
     lexConstructor->addRule("(" + rule + ")*", TerminalSymbol::ASSIGN_OP);
 
@@ -303,7 +314,7 @@ TEST(Asterisk, GroupAsteriskMatchesAndFail)
 
 TEST(Asterisk, TwoAsterisks)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("2*3*", TerminalSymbol::ASSIGN_OP);
     const std::string toParse = "22222333333333333";
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(toParse);
@@ -314,7 +325,7 @@ TEST(Asterisk, TwoAsterisks)
 
 TEST(Asterisk, AsteriskAndGroupMatchesLongest)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("2*", TerminalSymbol::BLANK);
     lexConstructor->addRule("2*", TerminalSymbol::CLOSED_BRACKET);
     lexConstructor->addRule("2*1", TerminalSymbol::ASSIGN_OP);
@@ -327,7 +338,7 @@ TEST(Asterisk, AsteriskAndGroupMatchesLongest)
 
 TEST(Asterisk, TwoAsteriskRulesFirstFails)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("3*", TerminalSymbol::BLANK);
     lexConstructor->addRule("2*", TerminalSymbol::ASSIGN_OP);
     const std::string toParse = "2222222";
@@ -340,7 +351,7 @@ TEST(Asterisk, TwoAsteriskRulesFirstFails)
 // ====== Dot ======
 TEST(Dot, DotMatchesAnyChar)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule(".", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("2");
     ASSERT_EQ(parseRes.size(), 1);
@@ -350,7 +361,7 @@ TEST(Dot, DotMatchesAnyChar)
 
 TEST(Dot, DotMatchesOnlySingleChar)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule(".", TerminalSymbol::ASSIGN_OP);
     const size_t toParseLength = 64;
     std::string toParse;
@@ -368,7 +379,7 @@ TEST(Dot, DotMatchesOnlySingleChar)
 // ====== Dot and Asterisk ======
 TEST(DotAndAsterisk, DotMatchesAnything)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule(".*", TerminalSymbol::ASSIGN_OP);
     const size_t toParseLength = 64;
     std::string toParse;
@@ -384,7 +395,7 @@ TEST(DotAndAsterisk, DotMatchesAnything)
 // ====== Asterisk and Union ======
 TEST(AsteriskAndUnion, AsteriskMatchesEachCharFromUnion)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     const std::string rule = "123456789";
     lexConstructor->addRule("[" + rule + "]*", TerminalSymbol::ASSIGN_OP);
 
@@ -403,7 +414,7 @@ TEST(AsteriskAndUnion, AsteriskMatchesEachCharFromUnion)
 // ====== Escaped symbols ======
 TEST(EscapedSymbols, EscapedDotMatchesDot)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\.", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(".");
     ASSERT_EQ(parseRes.size(), 1);
@@ -413,7 +424,7 @@ TEST(EscapedSymbols, EscapedDotMatchesDot)
 
 TEST(EscapedSymbols, EscapedDotMatchesCharFail)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\.", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("a");
     ASSERT_EQ(parseRes.size(), 1);
@@ -422,7 +433,7 @@ TEST(EscapedSymbols, EscapedDotMatchesCharFail)
 
 TEST(EscapedSymbols, EscapedOpenParMatchesOpenPar)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\(", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("(");
     ASSERT_EQ(parseRes.size(), 1);
@@ -432,7 +443,7 @@ TEST(EscapedSymbols, EscapedOpenParMatchesOpenPar)
 
 TEST(EscapedSymbols, EscapedCloseParMatchesClosePar)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\)", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(")");
     ASSERT_EQ(parseRes.size(), 1);
@@ -442,7 +453,7 @@ TEST(EscapedSymbols, EscapedCloseParMatchesClosePar)
 
 TEST(EscapedSymbols, EscapedOpenBracketMatchesOpenBracket)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\[", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("[");
     ASSERT_EQ(parseRes.size(), 1);
@@ -452,7 +463,7 @@ TEST(EscapedSymbols, EscapedOpenBracketMatchesOpenBracket)
 
 TEST(EscapedSymbols, EscapedCloseBracketMatchesCloseBracket)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\]", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("]");
     ASSERT_EQ(parseRes.size(), 1);
@@ -462,7 +473,7 @@ TEST(EscapedSymbols, EscapedCloseBracketMatchesCloseBracket)
 
 TEST(EscapedSymbols, EscapedTwoBracketsMatchesItself)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\[\\]", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("[]");
     ASSERT_EQ(parseRes.size(), 1);
@@ -472,7 +483,7 @@ TEST(EscapedSymbols, EscapedTwoBracketsMatchesItself)
 
 TEST(EscapedSymbols, EscapedAsterixMatchesAsterix)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\*", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("*");
     ASSERT_EQ(parseRes.size(), 1);
@@ -482,7 +493,7 @@ TEST(EscapedSymbols, EscapedAsterixMatchesAsterix)
 
 TEST(EscapedSymbols, EscapedPlusMatchesPlus)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\+", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("+");
     ASSERT_EQ(parseRes.size(), 1);
@@ -492,7 +503,7 @@ TEST(EscapedSymbols, EscapedPlusMatchesPlus)
 
 TEST(EscapedSymbols, EscapedBackslashMatchesBackslash)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\\\\", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("\\");
     ASSERT_EQ(parseRes.size(), 1);
@@ -502,7 +513,7 @@ TEST(EscapedSymbols, EscapedBackslashMatchesBackslash)
 
 TEST(EscapedSymbols, EscapedBackslashWithLettersMatchesItself)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("a\\\\b", TerminalSymbol::ASSIGN_OP);
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse("a\\b");
     ASSERT_EQ(parseRes.size(), 1);
@@ -512,7 +523,7 @@ TEST(EscapedSymbols, EscapedBackslashWithLettersMatchesItself)
 
 TEST(EscapedSymbols, EscapedBackslashInQuotesMatchesItself)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\"\\\\\"", TerminalSymbol::ASSIGN_OP);
     const std::string toParse = "\"\\\"";
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(toParse);
@@ -523,7 +534,7 @@ TEST(EscapedSymbols, EscapedBackslashInQuotesMatchesItself)
 
 TEST(EscapedSymbols, EscapedBackslashWithLettersInQuotesMatchesItself)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\"a\\\\b\"", TerminalSymbol::ASSIGN_OP);
     const std::string toParse = "\"a\\b\"";
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(toParse);
@@ -535,7 +546,7 @@ TEST(EscapedSymbols, EscapedBackslashWithLettersInQuotesMatchesItself)
 // TODO: Move tests from Misc to somewhere else or rename it
 TEST(Misc, LettersInQuotes)
 {
-    auto lexConstructor = std::make_shared<ThompsonConstructor>();
+    auto lexConstructor = std::make_shared<TestedConstructor>();
     lexConstructor->addRule("\"abc\"", TerminalSymbol::ASSIGN_OP);
     const std::string toParse = "\"abc\"";
     const auto parseRes = LexicalAnalyzer(lexConstructor).parse(toParse);
@@ -544,13 +555,86 @@ TEST(Misc, LettersInQuotes)
     EXPECT_EQ(parseRes[0]->text, toParse);
 }
 
+// ====== Character classes ======
+
+TEST(CharClass, Range)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("[a-c]+", TerminalSymbol::ID);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("abcacd");
+    ASSERT_EQ(parseRes.size(), 2);
+    EXPECT_EQ(parseRes[0]->symbolType, TerminalSymbol::ID);
+    EXPECT_EQ(parseRes[0]->text, "abcac");
+    EXPECT_EQ(parseRes[1]->symbolType, TerminalSymbol::ERROR);
+}
+
+TEST(CharClass, SeveralRanges)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("[a-zA-Z][a-zA-Z0-9]*", TerminalSymbol::ID);
+    lexConstructor->addRule("[0-9]+", TerminalSymbol::INT);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("Ab1z42Z");
+    ASSERT_EQ(parseRes.size(), 1);
+    EXPECT_EQ(parseRes[0]->symbolType, TerminalSymbol::ID);
+    EXPECT_EQ(parseRes[0]->text, "Ab1z42Z");
+    const auto intRes = LexicalAnalyzer(lexConstructor).parse("42Z");
+    ASSERT_EQ(intRes.size(), 2);
+    EXPECT_EQ(intRes[0]->symbolType, TerminalSymbol::INT);
+    EXPECT_EQ(intRes[1]->symbolType, TerminalSymbol::ID);
+}
+
+TEST(CharClass, Negated)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("\"[^\"]*\"", TerminalSymbol::STRING);
+    lexConstructor->addRule("[^a-z\"]", TerminalSymbol::INT);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("\"a (b) \\ 1\"1\xff" "a");
+    ASSERT_EQ(parseRes.size(), 4);
+    EXPECT_EQ(parseRes[0]->symbolType, TerminalSymbol::STRING);
+    EXPECT_EQ(parseRes[0]->text, "\"a (b) \\ 1\"");
+    EXPECT_EQ(parseRes[1]->symbolType, TerminalSymbol::INT);
+    EXPECT_EQ(parseRes[2]->symbolType, TerminalSymbol::INT);
+    EXPECT_EQ(parseRes[2]->text, "\xff");
+    EXPECT_EQ(parseRes[3]->symbolType, TerminalSymbol::ERROR);
+}
+
+TEST(CharClass, EscapedDashAndCaret)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("[a\\-c\\^]+", TerminalSymbol::ID);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("a-c^b");
+    ASSERT_EQ(parseRes.size(), 2);
+    EXPECT_EQ(parseRes[0]->text, "a-c^");
+    EXPECT_EQ(parseRes[1]->symbolType, TerminalSymbol::ERROR);
+}
+
+TEST(CharClass, NestedUnionsAndGroups)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("[[a-c][x-z](\\+)]+", TerminalSymbol::ID);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse("ax+cz+d");
+    ASSERT_EQ(parseRes.size(), 2);
+    EXPECT_EQ(parseRes[0]->text, "ax+cz+");
+    EXPECT_EQ(parseRes[1]->symbolType, TerminalSymbol::ERROR);
+}
+
+TEST(CharClass, RangeInUnionOfGroups)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("[a-c(>=)]", TerminalSymbol::ID);
+    const auto parseRes = LexicalAnalyzer(lexConstructor).parse(">=b");
+    ASSERT_EQ(parseRes.size(), 2);
+    EXPECT_EQ(parseRes[0]->text, ">=");
+    EXPECT_EQ(parseRes[1]->text, "b");
+}
+
 // ====== Real tokens ======
 class RealTokens : public ::testing::Test
 {
 protected:
     void SetUp() override
     {
-        lexConstructor = std::make_shared<ThompsonConstructor>();
+        lexConstructor = std::make_shared<TestedConstructor>();
         lexConstructor->addRule(ThompsonConstructor::allDigits + "+\\." +
                                     ThompsonConstructor::allDigits + "+",
                                 TerminalSymbol::INT);
@@ -665,6 +749,116 @@ TEST_F(RealTokens, MatchStringWithNewline)
     EXPECT_EQ(parseRes[4]->symbolType, TerminalSymbol::STRING);
 }
 
+TEST_F(RealTokens, TokenizeSkipsBlanksAndComments)
+{
+    const std::string toParse = "1\n; 123 this is a comment 1234234\n34 define";
+    const auto tokens = LexicalAnalyzer(lexConstructor)
+                            .tokenize(toParse, {TerminalSymbol::BLANK, TerminalSymbol::NEWLINE,
+                                                TerminalSymbol::COMMENT});
+    ASSERT_EQ(tokens.size(), 3);
+    EXPECT_EQ(tokens.getSymbolType(0), TerminalSymbol::INT);
+    EXPECT_EQ(tokens.getText(0), "1");
+    EXPECT_EQ(tokens.getSymbolType(1), TerminalSymbol::INT);
+    EXPECT_EQ(tokens.getText(1), "34");
+    EXPECT_EQ(tokens.getSymbolType(2), TerminalSymbol::DEFINE);
+    EXPECT_EQ(tokens.getText(2).data(), toParse.data() + toParse.size() - 6);
+}
+
+TEST_F(RealTokens, StreamWithTokensAcrossBufferBoundaries)
+{
+    const std::string toParse = "1\n; 123 this is a comment 1234234\n34 define \"some string\" "
+                                "4444.1234567 #\\a \"another longer string\"\n";
+    const auto expected = LexicalAnalyzer(lexConstructor).tokenize(toParse);
+    for (const size_t bufferSize : {1, 2, 3, 5, 8, 13, 64}) {
+        std::istringstream input(toParse);
+        TokenStream tokenStream(lexConstructor, input, {}, bufferSize);
+        size_t tokensCnt = 0;
+        while (const auto token = tokenStream.next()) {
+            ASSERT_LT(tokensCnt, expected.size());
+            EXPECT_EQ(token->symbolType, expected.getSymbolType(tokensCnt));
+            EXPECT_EQ(token->text, expected.getText(tokensCnt));
+            ++tokensCnt;
+        }
+        EXPECT_EQ(tokensCnt, expected.size());
+        EXPECT_FALSE(tokenStream.hasError());
+    }
+}
+
+TEST_F(RealTokens, StreamStopsAfterError)
+{
+    std::istringstream input("1 define ?? 2");
+    TokenStream tokenStream(lexConstructor, input, {TerminalSymbol::BLANK}, 4);
+    EXPECT_EQ(tokenStream.next()->symbolType, TerminalSymbol::INT);
+    EXPECT_EQ(tokenStream.next()->symbolType, TerminalSymbol::DEFINE);
+    EXPECT_EQ(tokenStream.next()->symbolType, TerminalSymbol::ERROR);
+    EXPECT_FALSE(tokenStream.next());
+    EXPECT_TRUE(tokenStream.hasError());
+}
+
+static void expectSameTokens(const TokenBuffer &expected, const TokenBuffer &tokens)
+{
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(tokens.getSymbolType(i), expected.getSymbolType(i));
+        EXPECT_EQ(tokens.getText(i).data(), expected.getText(i).data());
+        EXPECT_EQ(tokens.getText(i).size(), expected.getText(i).size());
+    }
+}
+
+TEST_F(RealTokens, ParallelTokenizeSameAsTokenize)
+{
+    std::string toParse;
+    for (size_t i = 0; i < 50; ++i) {
+        toParse += "1\n\n; 123 this is a comment 1234234\n34 define \"some string\"\n"
+                   "4444.1234567 #\\a \n";
+    }
+    LexicalAnalyzer lexicalAnalyzer(lexConstructor);
+    for (const auto &skippedSymbols : std::vector<std::set<TerminalSymbol>>{
+             {}, {TerminalSymbol::BLANK, TerminalSymbol::NEWLINE, TerminalSymbol::COMMENT}}) {
+        const auto expected = lexicalAnalyzer.tokenize(toParse, skippedSymbols);
+        for (const size_t chunkSize : {1, 3, 7, 64, 10000}) {
+            for (const size_t threadsCount : {1, 4}) {
+                expectSameTokens(expected, lexicalAnalyzer.tokenizeParallel(
+                                               toParse, skippedSymbols, threadsCount, chunkSize));
+            }
+        }
+    }
+}
+
+TEST_F(RealTokens, ParallelTokenizeStopsAtError)
+{
+    std::string toParse;
+    for (size_t i = 0; i < 20; ++i) {
+        toParse += i == 13 ? "1 define ?? 2\n" : "1 define 2\n";
+    }
+    LexicalAnalyzer lexicalAnalyzer(lexConstructor);
+    const auto expected = lexicalAnalyzer.tokenize(toParse);
+    ASSERT_EQ(expected.getSymbolType(expected.size() - 1), TerminalSymbol::ERROR);
+    for (const size_t chunkSize : {1, 5, 16}) {
+        expectSameTokens(expected, lexicalAnalyzer.tokenizeParallel(toParse, {}, 4, chunkSize));
+    }
+}
+
+TEST(ParallelTokenize, ResynchronisesInsideMultilineStrings)
+{
+    auto lexConstructor = std::make_shared<TestedConstructor>();
+    lexConstructor->addRule("\"[^\"]*\"", TerminalSymbol::STRING);
+    lexConstructor->addRule("[a-z]+", TerminalSymbol::ID);
+    lexConstructor->addRule(" ", TerminalSymbol::BLANK);
+    lexConstructor->addRule("\n+", TerminalSymbol::NEWLINE);
+    // the strings hold lines which look like code, so a chunk starting inside of a string is
+    // lexed as code and the code after the string is lexed as a string
+    std::string toParse;
+    for (size_t i = 0; i < 30; ++i) {
+        toParse += "abc def\n\n\"ghi\n jk \"\n\"\nlm\nno\npq\n\nrs\"\nxyz\n";
+    }
+    LexicalAnalyzer lexicalAnalyzer(lexConstructor);
+    const auto expected = lexicalAnalyzer.tokenize(toParse);
+    for (const size_t chunkSize : {1, 2, 5, 11, 100}) {
+        expectSameTokens(expected, lexicalAnalyzer.tokenizeParallel(toParse, {}, 3, chunkSize));
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
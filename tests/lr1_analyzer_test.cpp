@@ -1,7 +1,9 @@
 #include "parser_utils.hpp"
+#include "scheme_grammar.hpp"
 #include "syntax_analyzer.hpp"
 
 #include <gtest/gtest.h>
+#include <sstream>
 #include <stack>
 #include <string>
 
@@ -163,3 +165,279 @@ TEST(Recursion, MiddleRecursion)
     auto parseRes = syntaxAnalyzer->parse(getLeafsSt(expectedTree));
     cmpSts(expectedTree, parseRes);
 }
+
+TEST(Recursion, LongRuleDoesntOverflowStack)
+{
+    // every position of the rule is a state of its own, they are created one after another
+    auto syntaxAnalyzer =
+        std::make_shared<SyntaxAnalyzer>(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    Symbols rhs;
+    SymbolsSt children;
+    for (size_t i = 0; i < 2000; ++i) {
+        const auto terminal = i % 2 ? TerminalSymbol::ASSIGN_OP : TerminalSymbol::ID;
+        rhs.push_back(terminal);
+        children.push_back(std::make_shared<TerminalSymbolSt>(terminal, ""));
+    }
+    syntaxAnalyzer->addRule(NonTerminalSymbol::PROGRAM, rhs);
+    syntaxAnalyzer->start();
+    auto expectedTree = std::make_shared<NonTerminalSymbolSt>(NonTerminalSymbol::PROGRAM, children);
+    auto parseRes = syntaxAnalyzer->parse(getLeafsSt(expectedTree));
+    cmpSts(expectedTree, parseRes);
+}
+
+// ===== LALR(1) =====
+
+static void addArithmeticRules(SyntaxAnalyzer &syntaxAnalyzer)
+{
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROGRAM, {NonTerminalSymbol::EXPR});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::EXPR,
+                            {{NonTerminalSymbol::EXPR, TerminalSymbol::PLUS_OP,
+                              NonTerminalSymbol::OPERANDS},
+                             {NonTerminalSymbol::OPERANDS}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::OPERANDS,
+                            {{NonTerminalSymbol::OPERANDS, TerminalSymbol::MULT_OP,
+                              NonTerminalSymbol::OPERAND},
+                             {NonTerminalSymbol::OPERAND}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::OPERAND,
+                            {{TerminalSymbol::OPEN_BRACKET, NonTerminalSymbol::EXPR,
+                              TerminalSymbol::CLOSED_BRACKET},
+                             {TerminalSymbol::ID}});
+}
+
+TEST(Lalr, SameTreesWithFewerStates)
+{
+    SyntaxAnalyzer lr1Analyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    addArithmeticRules(lr1Analyzer);
+    lr1Analyzer.start();
+    SyntaxAnalyzer lalrAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                LrConstruction::LALR1);
+    addArithmeticRules(lalrAnalyzer);
+    lalrAnalyzer.start();
+    EXPECT_LT(lalrAnalyzer.getStatesCount(), lr1Analyzer.getStatesCount());
+
+    // a * (b + c) + d
+    const std::vector<TerminalSymbol> input = {
+        TerminalSymbol::ID,      TerminalSymbol::MULT_OP,        TerminalSymbol::OPEN_BRACKET,
+        TerminalSymbol::ID,      TerminalSymbol::PLUS_OP,        TerminalSymbol::ID,
+        TerminalSymbol::CLOSED_BRACKET, TerminalSymbol::PLUS_OP, TerminalSymbol::ID,
+        TerminalSymbol::FINISH};
+    TerminalSymbolsSt symbols;
+    for (const auto terminal : input) {
+        symbols.push_back(std::make_shared<TerminalSymbolSt>(terminal, ""));
+    }
+    const auto lr1Tree = lr1Analyzer.parse(symbols);
+    const auto lalrTree = lalrAnalyzer.parse(symbols);
+    ASSERT_TRUE(lr1Tree);
+    ASSERT_TRUE(lalrTree);
+    cmpSts(lr1Tree, lalrTree);
+}
+
+TEST(Lalr, LookaheadsReadThroughNullableSymbols)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                  LrConstruction::LALR1);
+    syntaxAnalyzer.addRule(
+        NonTerminalSymbol::PROGRAM,
+        {NonTerminalSymbol::EXPR, NonTerminalSymbol::OPERANDS, TerminalSymbol::ID});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::EXPR, {TerminalSymbol::ID});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::OPERANDS,
+                            {{}, {NonTerminalSymbol::OPERANDS, NonTerminalSymbol::OPERAND}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::OPERAND, {TerminalSymbol::INT});
+    syntaxAnalyzer.start();
+
+    auto makeTerminal = [](TerminalSymbol symbol) {
+        return std::make_shared<TerminalSymbolSt>(symbol, "");
+    };
+    auto makeOperand = [&]() {
+        return std::make_shared<NonTerminalSymbolSt>(NonTerminalSymbol::OPERAND,
+                                                     SymbolsSt{makeTerminal(TerminalSymbol::INT)});
+    };
+    auto operands = std::make_shared<NonTerminalSymbolSt>(NonTerminalSymbol::OPERANDS);
+    for (size_t i = 0; i < 2; ++i) {
+        operands = std::make_shared<NonTerminalSymbolSt>(NonTerminalSymbol::OPERANDS,
+                                                         SymbolsSt{operands, makeOperand()});
+    }
+    auto expr = std::make_shared<NonTerminalSymbolSt>(NonTerminalSymbol::EXPR,
+                                                      SymbolsSt{makeTerminal(TerminalSymbol::ID)});
+    auto expectedTree = std::make_shared<NonTerminalSymbolSt>(
+        NonTerminalSymbol::PROGRAM, SymbolsSt{expr, operands, makeTerminal(TerminalSymbol::ID)});
+    auto parseRes = syntaxAnalyzer.parse(getLeafsSt(expectedTree));
+    ASSERT_TRUE(parseRes);
+    cmpSts(expectedTree, parseRes);
+}
+
+// S -> aAd | bBd | aBe | bAe, A -> c, B -> c is LR(1), but merging the states after "a c" and
+// "b c" gives a reduce/reduce conflict
+static void addNotLalrRules(SyntaxAnalyzer &syntaxAnalyzer)
+{
+    const Symbol a = TerminalSymbol::ID, b = TerminalSymbol::INT, d = TerminalSymbol::PLUS_OP,
+                 e = TerminalSymbol::MINUS_OP;
+    const Symbol A = NonTerminalSymbol::EXPR, B = NonTerminalSymbol::OPERAND;
+    syntaxAnalyzer.addRules(NonTerminalSymbol::PROGRAM,
+                            {{a, A, d}, {b, B, d}, {a, B, e}, {b, A, e}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::EXPR, {TerminalSymbol::ASSIGN_OP});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::OPERAND, {TerminalSymbol::ASSIGN_OP});
+}
+
+TEST(Lalr, ReduceReduceConflictIsReported)
+{
+    SyntaxAnalyzer lr1Analyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    addNotLalrRules(lr1Analyzer);
+    lr1Analyzer.start();
+
+    EXPECT_EXIT(
+        {
+            SyntaxAnalyzer lalrAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                        LrConstruction::LALR1);
+            addNotLalrRules(lalrAnalyzer);
+            lalrAnalyzer.start();
+        },
+        // the conflict is logged to stdout
+        ::testing::ExitedWithCode(1), "");
+}
+
+// ===== Items =====
+
+TEST(Items, PackedFieldsAndOrder)
+{
+    const Item item(3, 2, static_cast<uint32_t>(TerminalSymbol::ID));
+    EXPECT_EQ(item.getRuleIndex(), 3);
+    EXPECT_EQ(item.getPos(), 2);
+    EXPECT_EQ(item.getLookahead(), static_cast<uint32_t>(TerminalSymbol::ID));
+    EXPECT_TRUE(item.hasLookahead());
+    EXPECT_EQ(item.advance().getPos(), 3);
+    EXPECT_EQ(item.advance().getRuleIndex(), 3);
+    EXPECT_FALSE(Item(3, 2, Item::noLookahead).hasLookahead());
+
+    // ordered by the rule, then by the position and then by the lookahead
+    EXPECT_LT(Item(0, 5, Item::noLookahead), Item(1, 0, 0));
+    EXPECT_LT(Item(1, 0, Item::noLookahead), Item(1, 1, 0));
+    EXPECT_LT(Item(1, 1, 0), Item(1, 1, 1));
+}
+
+// ===== FIRST and FOLLOW =====
+
+static SyntaxAnalyzer::TerminalsSet makeTerminalsSet(std::initializer_list<TerminalSymbol> symbols)
+{
+    SyntaxAnalyzer::TerminalsSet res;
+    for (const auto symbol : symbols) {
+        res[static_cast<size_t>(symbol)] = true;
+    }
+    return res;
+}
+
+TEST(FirstFollow, RecursiveNonTerminals)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    addArithmeticRules(syntaxAnalyzer);
+    syntaxAnalyzer.start();
+
+    const auto first = makeTerminalsSet({TerminalSymbol::OPEN_BRACKET, TerminalSymbol::ID});
+    EXPECT_EQ(syntaxAnalyzer.getFirst(NonTerminalSymbol::PROGRAM), first);
+    EXPECT_EQ(syntaxAnalyzer.getFirst(NonTerminalSymbol::EXPR), first);
+    EXPECT_EQ(syntaxAnalyzer.getFirst(NonTerminalSymbol::OPERAND), first);
+    EXPECT_FALSE(syntaxAnalyzer.isNullable(NonTerminalSymbol::EXPR));
+
+    EXPECT_EQ(syntaxAnalyzer.getFollow(NonTerminalSymbol::EXPR),
+              makeTerminalsSet({TerminalSymbol::FINISH, TerminalSymbol::PLUS_OP,
+                                TerminalSymbol::CLOSED_BRACKET}));
+    EXPECT_EQ(syntaxAnalyzer.getFollow(NonTerminalSymbol::OPERAND),
+              makeTerminalsSet({TerminalSymbol::FINISH, TerminalSymbol::PLUS_OP,
+                                TerminalSymbol::CLOSED_BRACKET, TerminalSymbol::MULT_OP}));
+}
+
+TEST(FirstFollow, NullableNonTerminals)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    syntaxAnalyzer.addRule(NonTerminalSymbol::PROGRAM,
+                           {NonTerminalSymbol::EXPR, NonTerminalSymbol::OPERANDS});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::EXPR, {{}, {TerminalSymbol::ID}});
+    syntaxAnalyzer.addRules(NonTerminalSymbol::OPERANDS,
+                            {{}, {NonTerminalSymbol::OPERAND, NonTerminalSymbol::OPERANDS}});
+    syntaxAnalyzer.addRule(NonTerminalSymbol::OPERAND, {TerminalSymbol::INT});
+    syntaxAnalyzer.start();
+
+    EXPECT_TRUE(syntaxAnalyzer.isNullable(NonTerminalSymbol::PROGRAM));
+    EXPECT_TRUE(syntaxAnalyzer.isNullable(NonTerminalSymbol::EXPR));
+    EXPECT_FALSE(syntaxAnalyzer.isNullable(NonTerminalSymbol::OPERAND));
+    EXPECT_EQ(syntaxAnalyzer.getFirst(NonTerminalSymbol::PROGRAM),
+              makeTerminalsSet({TerminalSymbol::ID, TerminalSymbol::INT}));
+    EXPECT_EQ(syntaxAnalyzer.getFollow(NonTerminalSymbol::EXPR),
+              makeTerminalsSet({TerminalSymbol::INT, TerminalSymbol::FINISH}));
+    EXPECT_EQ(syntaxAnalyzer.getFollow(NonTerminalSymbol::OPERAND),
+              makeTerminalsSet({TerminalSymbol::INT, TerminalSymbol::FINISH}));
+
+    // both nullable symbols are skipped
+    const auto parseRes = syntaxAnalyzer.parse(
+        TerminalSymbolsSt{std::make_shared<TerminalSymbolSt>(TerminalSymbol::FINISH, "")});
+    ASSERT_TRUE(parseRes);
+}
+
+TEST(Errors, UnexpectedTokenGivesNoTree)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH);
+    addArithmeticRules(syntaxAnalyzer);
+    syntaxAnalyzer.start();
+    TerminalSymbolsSt symbols;
+    for (const auto terminal : {TerminalSymbol::ID, TerminalSymbol::PLUS_OP,
+                                TerminalSymbol::CLOSED_BRACKET, TerminalSymbol::FINISH}) {
+        symbols.push_back(std::make_shared<TerminalSymbolSt>(terminal, ""));
+    }
+    EXPECT_FALSE(syntaxAnalyzer.parse(symbols));
+}
+
+// ===== Parallel construction =====
+
+static std::string buildSchemeTables(LrConstruction construction, size_t threadsCount)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                  construction);
+    addSchemeGrammarRules(syntaxAnalyzer);
+    syntaxAnalyzer.start(threadsCount);
+    std::stringstream tables;
+    syntaxAnalyzer.writeTables(tables, "tables");
+    return tables.str();
+}
+
+TEST(Parallel, SameTablesForAnyThreadsCount)
+{
+    for (const auto construction : {LrConstruction::CANONICAL_LR1, LrConstruction::LALR1}) {
+        const auto tables = buildSchemeTables(construction, 1);
+        for (const size_t threadsCount : {2, 4, 7}) {
+            EXPECT_EQ(buildSchemeTables(construction, threadsCount), tables);
+        }
+    }
+}
+
+// ===== GeneratedTables =====
+
+TEST(GeneratedTables, SameAsBuiltAtRuntime)
+{
+    SyntaxAnalyzer syntaxAnalyzer(NonTerminalSymbol::PROGRAM, TerminalSymbol::FINISH,
+                                  LrConstruction::LALR1);
+    addSchemeGrammarRules(syntaxAnalyzer);
+    syntaxAnalyzer.start();
+    const auto loadedAnalyzer = makeSchemeSyntaxAnalyzer();
+    EXPECT_EQ(loadedAnalyzer->getStatesCount(), syntaxAnalyzer.getStatesCount());
+
+    std::stringstream builtTables, loadedTables;
+    syntaxAnalyzer.writeTables(builtTables, "tables");
+    loadedAnalyzer->writeTables(loadedTables, "tables");
+    EXPECT_EQ(builtTables.str(), loadedTables.str());
+}
+
+TEST(GeneratedTables, ParseProcedureCall)
+{
+    auto makeTerminal = [](TerminalSymbol symbol) {
+        return std::make_shared<TerminalSymbolSt>(symbol, "");
+    };
+    // (f 1)
+    TerminalSymbolsSt symbols = {
+        makeTerminal(TerminalSymbol::OPEN_BRACKET), makeTerminal(TerminalSymbol::ID),
+        makeTerminal(TerminalSymbol::INT), makeTerminal(TerminalSymbol::CLOSED_BRACKET),
+        makeTerminal(TerminalSymbol::FINISH)};
+    const auto parseRes = makeSchemeSyntaxAnalyzer()->parse(symbols);
+    ASSERT_TRUE(parseRes);
+    EXPECT_EQ(parseRes->symbolType, NonTerminalSymbol::PROGRAM);
+    EXPECT_EQ(getLeafsSt(parseRes).size(), symbols.size());
+}
@@ -0,0 +1,136 @@
+#include "parse_tables.hpp"
+#include "scheme_grammar.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+constexpr size_t terminalsCount = ParseTables::terminalsCount;
+constexpr size_t nonTerminalsCount = ParseTables::nonTerminalsCount;
+
+struct DenseTables
+{
+    std::vector<ParseAction> actions;
+    std::vector<uint32_t> gotos;
+};
+
+// about a tenth of the actions are shifts, some rows reduce by a single rule and some by several
+static DenseTables makeRandomTables(size_t statesCount, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    DenseTables tables{std::vector<ParseAction>(statesCount * terminalsCount, 0),
+                       std::vector<uint32_t>(statesCount * nonTerminalsCount, 0)};
+    for (size_t state = 0; state < statesCount; ++state) {
+        const size_t rulesCount = random() % 3;
+        for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+            ParseAction &action = tables.actions[state * terminalsCount + terminal];
+            if (random() % 10 == 0) {
+                action = static_cast<ParseAction>(random() % statesCount) + 1;
+            } else if (rulesCount > 0 && random() % 4 == 0) {
+                action = -static_cast<ParseAction>(state + random() % rulesCount) - 1;
+            }
+        }
+        for (size_t nonTerminal = 0; nonTerminal < nonTerminalsCount; ++nonTerminal) {
+            if (random() % 8 == 0) {
+                tables.gotos[state * nonTerminalsCount + nonTerminal] =
+                    static_cast<uint32_t>(random() % statesCount) + 1;
+            }
+        }
+    }
+    return tables;
+}
+
+// the missing actions may only give the single reduction of the state
+static void checkSameAsDense(const ParseTables &parseTables, const DenseTables &tables)
+{
+    const size_t statesCount = tables.actions.size() / terminalsCount;
+    ASSERT_EQ(parseTables.getStatesCount(), statesCount);
+    for (size_t state = 0; state < statesCount; ++state) {
+        std::set<ParseAction> reductions;
+        for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+            if (const auto action = tables.actions[state * terminalsCount + terminal]; action < 0) {
+                reductions.insert(action);
+            }
+        }
+        for (size_t terminal = 0; terminal < terminalsCount; ++terminal) {
+            const auto action = tables.actions[state * terminalsCount + terminal];
+            const auto packedAction = parseTables.getAction(static_cast<uint32_t>(state),
+                                                            static_cast<TerminalSymbol>(terminal));
+            if (action != 0) {
+                EXPECT_EQ(packedAction, action) << "state " << state << ", terminal " << terminal;
+            } else if (packedAction != 0) {
+                EXPECT_EQ(reductions.size(), 1);
+                EXPECT_EQ(packedAction, *reductions.begin());
+            }
+        }
+        for (size_t nonTerminal = 0; nonTerminal < nonTerminalsCount; ++nonTerminal) {
+            EXPECT_EQ(parseTables.getGoto(static_cast<uint32_t>(state),
+                                          static_cast<NonTerminalSymbol>(nonTerminal)),
+                      tables.gotos[state * nonTerminalsCount + nonTerminal]);
+        }
+    }
+}
+
+// ===== Packing =====
+
+TEST(Packing, SameAsDenseTables)
+{
+    for (const size_t statesCount : {1, 2, 10, 100, 500}) {
+        const auto tables = makeRandomTables(statesCount, static_cast<uint32_t>(statesCount));
+        const ParseTables parseTables(tables.actions, tables.gotos);
+        checkSameAsDense(parseTables, tables);
+        EXPECT_LT(parseTables.getPackedSize(),
+                  statesCount * (terminalsCount + nonTerminalsCount) + terminalsCount +
+                      nonTerminalsCount);
+    }
+}
+
+TEST(Packing, EmptyRows)
+{
+    const DenseTables tables{std::vector<ParseAction>(3 * terminalsCount, 0),
+                             std::vector<uint32_t>(3 * nonTerminalsCount, 0)};
+    const ParseTables parseTables(tables.actions, tables.gotos);
+    checkSameAsDense(parseTables, tables);
+    EXPECT_EQ(parseTables.getPackedSize(), terminalsCount + nonTerminalsCount);
+}
+
+TEST(Packing, SingleReductionBecomesDefault)
+{
+    DenseTables tables{std::vector<ParseAction>(2 * terminalsCount, 0),
+                       std::vector<uint32_t>(2 * nonTerminalsCount, 0)};
+    // the first state shifts an identifier and reduces by the rule 3 on two terminals
+    tables.actions[static_cast<size_t>(TerminalSymbol::ID)] = 2;
+    tables.actions[static_cast<size_t>(TerminalSymbol::INT)] = -4;
+    tables.actions[static_cast<size_t>(TerminalSymbol::FINISH)] = -4;
+    // the second state reduces by two rules, so it has no default reduction
+    tables.actions[terminalsCount + static_cast<size_t>(TerminalSymbol::INT)] = -1;
+    tables.actions[terminalsCount + static_cast<size_t>(TerminalSymbol::FINISH)] = -2;
+    const ParseTables parseTables(tables.actions, tables.gotos);
+    checkSameAsDense(parseTables, tables);
+
+    EXPECT_EQ(parseTables.getAction(0, TerminalSymbol::STRING), -4);
+    EXPECT_EQ(parseTables.getAction(1, TerminalSymbol::STRING), 0);
+    // only the shift and the two reductions of the second state are packed
+    const auto packed = parseTables.getPacked();
+    EXPECT_EQ(std::count_if(packed.actions.begin(), packed.actions.end(),
+                            [](ParseAction action) { return action != 0; }),
+              3);
+}
+
+TEST(Packing, LoadedFromPacked)
+{
+    const auto tables = makeRandomTables(50, 1);
+    const ParseTables parseTables(tables.actions, tables.gotos);
+    const ParseTables loadedTables(parseTables.getPacked());
+    checkSameAsDense(loadedTables, tables);
+}
+
+// ===== Scheme tables =====
+
+TEST(SchemeTables, SmallerThanDense)
+{
+    const auto syntaxAnalyzer = makeSchemeSyntaxAnalyzer();
+    const auto &parseTables = syntaxAnalyzer->getParseTables();
+    const size_t denseSize = parseTables.getStatesCount() * (terminalsCount + nonTerminalsCount);
+    EXPECT_LT(parseTables.getPackedSize() * 2, denseSize);
+}